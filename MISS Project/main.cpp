@@ -9,7 +9,10 @@
 #include <SFGUI\Widgets.hpp>
 
 #include "simulation\map.h"
+#include "simulation\map_generator.h"
 #include "simulation\simulation.h"
+#include "simulation\simulation_runner.h"
+#include "simulation\simulation_view.h"
 
 #include "simulation\utils.h"
 
@@ -27,18 +30,94 @@ struct InitData
 // -----
 
 template <typename T>
-void add_new_scrollbar(sfg::Box::Ptr _ptr, float _min, float _max, float _step, std::string const &_text, T &_opts);
+void add_new_scrollbar(sfg::Box::Ptr _ptr, SimulationRunner &_runner, float _min, float _max, float _step, std::string const &_text, T &_opts);
 
 void parse_options(std::string _file_name, SimulationOptions &_opts);
 
 InitData read_init(std::string const &_file_name);
 
 
-int main_test(int argc, char *argv[])
+int main_convert(int argc, char *argv[])
 {
     if (argc <= 2) {
         std::cout << "Not enough arguments." << std::endl;
-        std::cout << "Usage: miss.exe [params_file] [map_file] [num_of_tests] [num_of_steps_per_test]" << std::endl;
+        std::cout << "Usage: miss.exe convert [input_map] [output_map]" << std::endl;
+        std::cout << "Output maps with .mpb extension are written in binary format." << std::endl;
+        return 0;
+    }
+
+    Map map;
+    if (!map.load(argv[1])) {
+        return 1;
+    }
+
+    if (!map.save(argv[2])) {
+        return 1;
+    }
+
+    std::cout << "Converted " << argv[1] << " (" << map.dimensions().y << "x" << map.dimensions().x << ") to " << argv[2] << std::endl;
+    return 0;
+}
+
+
+int main_generate(int argc, char *argv[])
+{
+    if (argc <= 1) {
+        std::cout << "Not enough arguments." << std::endl;
+        std::cout << "Usage: miss.exe generate [output_map] [name=value ...]" << std::endl;
+        std::cout << "Parameters: width, height, seed, food, water, danger, blocked, cluster, start_x, start_y" << std::endl;
+        std::cout << "Output maps with .mpb extension are written in binary format." << std::endl;
+        return 0;
+    }
+
+    MapGeneratorOptions gen_opts;
+    for (int i = 2; i < argc; ++i) {
+        auto &&spl = split(argv[i], '=');
+        if (spl.size() != 2) {
+            std::cout << "Skipping malformed parameter: " << argv[i] << std::endl;
+            continue;
+        }
+        auto &&name = trim(spl[0]);
+        auto &&val = trim(spl[1]);
+
+        if (name == "width") {
+            gen_opts.width = from_string<int>(val);
+        } else if (name == "height") {
+            gen_opts.height = from_string<int>(val);
+        } else if (name == "seed") {
+            gen_opts.seed = from_string<unsigned long long>(val);
+        } else if (name == "food") {
+            gen_opts.food_density = from_string<double>(val);
+        } else if (name == "water") {
+            gen_opts.water_density = from_string<double>(val);
+        } else if (name == "danger") {
+            gen_opts.danger_density = from_string<double>(val);
+        } else if (name == "blocked") {
+            gen_opts.blocked_density = from_string<double>(val);
+        } else if (name == "cluster") {
+            gen_opts.cluster_size = from_string<int>(val);
+        } else if (name == "start_x") {
+            gen_opts.start.x = from_string<int>(val);
+        } else if (name == "start_y") {
+            gen_opts.start.y = from_string<int>(val);
+        } else {
+            std::cout << "Unknown parameter: " << name << std::endl;
+        }
+    }
+
+    sf::Clock gen_timer;
+    Map map = generate_map(gen_opts);
+    std::cout << "Generated " << map.dimensions().y << "x" << map.dimensions().x << " map in " << gen_timer.getElapsedTime().asSeconds() << "s" << std::endl;
+
+    return map.save(argv[1]) ? 0 : 1;
+}
+
+
+int main_test(int argc, char *argv[])
+{
+    if (argc < 5) {
+        std::cout << "Not enough arguments." << std::endl;
+        std::cout << "Usage: miss.exe test [params_file] [map_file] [num_of_tests] [num_of_steps_per_test]" << std::endl;
         return 0;
     }
 
@@ -49,6 +128,16 @@ int main_test(int argc, char *argv[])
     std::string map_file(argv[2]);
     int num_of_tests = from_string<int>(argv[3]);
     int max_steps = from_string<int>(argv[4]);
+    if (num_of_tests <= 0 || max_steps <= 0) {
+        std::cout << "Number of tests and steps must be positive." << std::endl;
+        return 1;
+    }
+#ifndef MISS_COUNT_ALLOCATIONS
+    if (options.max_allocs_per_step > 0.0) {
+        std::cout << "max_allocs_per_step requires a build with MISS_COUNT_ALLOCATIONS." << std::endl;
+        return 1;
+    }
+#endif
     // -----
 
     std::cout << "Name: " << options.name << std::endl << std::endl;
@@ -65,35 +154,60 @@ int main_test(int argc, char *argv[])
     unsigned int survived_simulations = 0;
 
     std::vector<unsigned int> dead(max_steps, 0);
+    bool allocs_exceeded = false;
+
+    Map loaded_map;
+    if (!loaded_map.load(map_file)) {
+        return 1;
+    }
+
+    // statystyki pol sumowane ze wszystkich testow
+    CellStats total_stats;
+    total_stats.reset(loaded_map.dimensions());
 
     for (int i = 0; i < num_of_tests; ++i) {
-        Map map;
-        map.load(map_file);
+        Map map = loaded_map;
 
         double possible_discoveries = map.dimensions().x * map.dimensions().y;
 
         Simulation sim(map, options);
         SimulationOptions &opts = sim.get_options();
 
+#ifdef MISS_COUNT_ALLOCATIONS
+        // pierwsza polowa testu wypelnia bufory i struktury wiedzy, wiec alokacje liczone sa od polowy
+        const int half_steps = max_steps / 2;
+        auto allocations_before = allocation_count();
+#endif
+
+        // krok zwieksza licznik przed zapisem statystyk - krok n zapisywany jest pod indeksem n - 1
+        double food = 0.0, discovery = 0.0;
         while (!sim.is_finished() && opts.step_counter < max_steps) {
+#ifdef MISS_COUNT_ALLOCATIONS
+            if (opts.step_counter == half_steps) {
+                allocations_before = allocation_count();
+            }
+#endif
             sim.step();
 
-            average_agents[opts.step_counter] += static_cast<double>(sim.agents_count());
-            average_food[opts.step_counter] += static_cast<double>(opts.total_food);
-            average_discovery[opts.step_counter] += static_cast<double>(sim.get_env().get_discovered().size()) / possible_discoveries;
+            food = static_cast<double>(opts.total_food);
+            discovery = static_cast<double>(sim.get_env().get_stats().discovered()) / possible_discoveries;
+            average_agents[opts.step_counter - 1] += static_cast<double>(sim.agents_count());
+            average_food[opts.step_counter - 1] += food;
+            average_discovery[opts.step_counter - 1] += discovery;
         }
 
         if (opts.step_counter == max_steps) {
             std::cout << "Population survived." << std::endl;
             ++survived_simulations;
         } else {
-            for (unsigned int left = opts.step_counter + 1; left < max_steps; ++left) {
-                average_food[left] += average_food[opts.step_counter];
-                average_discovery[left] += average_discovery[opts.step_counter];
+            // po wymarciu populacji jedzenie i odkrycie pozostaja na ostatnim poziomie tego testu
+            for (int left = opts.step_counter; left < max_steps; ++left) {
+                average_food[left] += food;
+                average_discovery[left] += discovery;
             }
         }
 
-        discovered_prec[i] = static_cast<double>(sim.get_env().get_discovered().size()) / possible_discoveries;
+        discovered_prec[i] = static_cast<double>(sim.get_env().get_stats().discovered()) / possible_discoveries;
         average_steps[i] = static_cast<double>(opts.step_counter);
         food_at_end[i] = opts.total_food;
 
@@ -106,11 +220,23 @@ int main_test(int argc, char *argv[])
         }
 
         average_lifetime[i] = avg_lt;
+        total_stats.accumulate(sim.get_env().get_stats());
 
         std::cout << "\tDiscovered:    " << discovered_prec[i] << std::endl;
         std::cout << "\tSteps:         " << average_steps[i] << std::endl;
         std::cout << "\tAvg. lifetime: " << avg_lt << std::endl;
         std::cout << "\tGathered food: " << opts.total_food << std::endl;
+#ifdef MISS_COUNT_ALLOCATIONS
+        // populacja wymarla przed polowa testu - brak pomiaru
+        if (opts.step_counter > half_steps) {
+            double allocs = static_cast<double>(allocation_count() - allocations_before) / (opts.step_counter - half_steps);
+            std::cout << "\tAllocs/step:   " << allocs << std::endl;
+            if (options.max_allocs_per_step > 0.0 && allocs > options.max_allocs_per_step) {
+                std::cout << "\tAllocs/step exceeded limit " << options.max_allocs_per_step << "!" << std::endl;
+                allocs_exceeded = true;
+            }
+        }
+#endif
         std::cout << std::endl;
     }
 
@@ -195,12 +321,32 @@ int main_test(int argc, char *argv[])
     } results << std::endl;
 
     results.close();
-    return 0;
+
+    // -----
+
+    std::ofstream heatmap(options.name + "_heatmap.txt");
+    for (int c = 0; c < CellStats::CountersNum; ++c) {
+        heatmap << "# " << CellStats::name(static_cast<CellStats::Counter>(c)) << std::endl;
+        total_stats.dump(heatmap, static_cast<CellStats::Counter>(c));
+    }
+    heatmap.close();
+    return allocs_exceeded ? 2 : 0;
 }
 
 
-int main()
+int main(int argc, char *argv[])
 {
+    if (argc > 1) {
+        std::string mode = argv[1];
+        if (mode == "convert") {
+            return main_convert(argc - 1, argv + 1);
+        } else if (mode == "generate") {
+            return main_generate(argc - 1, argv + 1);
+        } else if (mode == "test") {
+            return main_test(argc - 1, argv + 1);
+        }
+    }
+
     auto init = read_init("init.conf");
 
     sfg::SFGUI sfgui;
@@ -213,10 +359,10 @@ int main()
     // -- Simulation
     // -----
 
-    sf::Clock sim_timer;
-
     Map map;
-    map.load(init.map_file);
+    if (!map.load(init.map_file)) {
+        return 1;
+    }
 
     SimulationOptions start_opts;
     if (!init.option_file.empty()) {
@@ -227,13 +373,23 @@ int main()
 
     SimulationOptions &opts = sim.get_options();
 
+    // symulacja wykonywana jest w osobnym watku, okno rysuje jedynie migawki jej stanu
+    SimulationView sim_view;
+    sim_view.reset(map);
+
+    SimulationRunner runner(sim, map);
+    SimulationSnapshot snapshot;
+
 
     // -- GUI
     // -----
     int change_map_opt = 0;
     bool run_simulation = false;
+    bool turbo = false;
+    int heat_layer = -1;
 
     bool drag = false;
+    float zoom = 1.0f;
     sf::Vector2f last_pos;
     bool allow_gui = false;
 
@@ -261,46 +417,68 @@ int main()
 
     auto next_button = sfg::Button::Create("Next agent");
     next_button->GetSignal(sfg::Button::OnLeftClick).Connect([&]() {
-        sim.show_next_agent();
+        runner.post([](Simulation &_sim, Map &) { _sim.show_next_agent(); });
     });
     button_box->Pack(next_button);
 
     auto no_view_button = sfg::Button::Create("Default view");
     no_view_button->GetSignal(sfg::Button::OnLeftClick).Connect([&]() {
-        sim.disable_view();
+        runner.post([](Simulation &_sim, Map &) { _sim.disable_view(); });
     });
     button_box->Pack(no_view_button);
 
     auto play_button = sfg::Button::Create("Play");
     play_button->GetSignal(sfg::Button::OnLeftClick).Connect([&]() {
         run_simulation = !run_simulation;
+        runner.set_running(run_simulation);
         play_button->SetLabel(run_simulation ? "Pause" : "Play");
     });
     button_box->Pack(play_button);
+
+    auto turbo_button = sfg::Button::Create("Turbo");
+    turbo_button->GetSignal(sfg::Button::OnLeftClick).Connect([&]() {
+        turbo = !turbo;
+        runner.set_turbo(turbo);
+        turbo_button->SetLabel(turbo ? "[Turbo]" : "Turbo");
+    });
+    button_box->Pack(turbo_button);
     box->Pack(button_box);
 
-    add_new_scrollbar(box, 0.0f, 1.0f, 0.05f, "Target threshold", opts.target_threshold);
-    add_new_scrollbar(box, 0.0f, 1.0f, 0.05f, "Share good path and place", opts.share_good_path_place);
-    add_new_scrollbar(box, 0.0f, 1.0f, 0.05f, "Share good path", opts.share_good_path);
-    add_new_scrollbar(box, 0.0f, 1.0f, 0.05f, "Share good place", opts.share_good_place);
-    add_new_scrollbar(box, 0.0f, 1.0f, 0.05f, "Share good distr. place", opts.share_good_distributed_place);
-    add_new_scrollbar(box, 0.0f, 1.0f, 0.05f, "Share good direction", opts.share_good_direction);
-    add_new_scrollbar(box, 0.0f, 1.0f, 0.05f, "Share bad place", opts.share_bad_place);
-    add_new_scrollbar(box, 0.0f, 1.0f, 0.05f, "Share bad distr. place", opts.share_bad_distributed_place);
-    add_new_scrollbar(box, 0.0f, 1.0f, 0.05f, "Risky choices", opts.risky_choices);
-    add_new_scrollbar(box, 0.0f, 1.0f, 0.05f, "Survival chance", opts.survival_chance);
-    add_new_scrollbar(box, -1.f, 1.0f, 0.05f, "Good threshold", opts.good_threshold);
-    add_new_scrollbar(box, -1.f, 1.0f, 0.05f, "Bad threshold", opts.bad_threshold);
-    add_new_scrollbar(box, 0.0f, 150.0f, 25.f, "Share radius", opts.share_radius);
-    add_new_scrollbar(box, 0.0f, 1.0f, 0.05f, "Share chance", opts.share_chance);
-    add_new_scrollbar(box, 0.0f, 1.0f, 0.05f, "Repeated share chance", opts.repeated_share);
-    add_new_scrollbar(box, 2.0f, 5.0f, 1.0f, "Distribute radius", opts.distribute_radius);
-    add_new_scrollbar(box, 1.0f, 50.f, 5.f, "Learn time", opts.learn_time);
-    add_new_scrollbar(box, 0.0f, 500.f, 25.f, "Survive without food", opts.foodless_survival);
-    add_new_scrollbar(box, 1.0f, 2000.f, 25.f, "Terrain modify time [steps]", opts.terrain_modify_step);
-    add_new_scrollbar(box, 1.0f, 100.0f, 5.f, "Default field value", opts.default_field_value);
-    add_new_scrollbar(box, 1.0f, 1000.0f, 20.f, "Agent spawn time [steps]", opts.agent_spawn_time);
-    add_new_scrollbar(box, 0.0f, 2.0f, 0.025f, "Step time [s]", opts.step_time);
+    auto heat_button = sfg::Button::Create("Heatmap: off");
+    heat_button->GetSignal(sfg::Button::OnLeftClick).Connect([&]() {
+        heat_layer = heat_layer + 1 < CellStats::CountersNum ? heat_layer + 1 : -1;
+        runner.set_heat_layer(heat_layer);
+        heat_button->SetLabel(std::string("Heatmap: ") + (heat_layer >= 0 ? CellStats::name(static_cast<CellStats::Counter>(heat_layer)) : "off"));
+    });
+    box->Pack(heat_button);
+
+    auto sps_label = sfg::Label::Create("Steps/s: 0");
+    int shown_sps = 0;
+    box->Pack(sps_label);
+
+    add_new_scrollbar(box, runner, 0.0f, 1.0f, 0.05f, "Target threshold", opts.target_threshold);
+    add_new_scrollbar(box, runner, 0.0f, 1.0f, 0.05f, "Share good path and place", opts.share_good_path_place);
+    add_new_scrollbar(box, runner, 0.0f, 1.0f, 0.05f, "Share good path", opts.share_good_path);
+    add_new_scrollbar(box, runner, 0.0f, 1.0f, 0.05f, "Share good place", opts.share_good_place);
+    add_new_scrollbar(box, runner, 0.0f, 1.0f, 0.05f, "Share good distr. place", opts.share_good_distributed_place);
+    add_new_scrollbar(box, runner, 0.0f, 1.0f, 0.05f, "Share good direction", opts.share_good_direction);
+    add_new_scrollbar(box, runner, 0.0f, 1.0f, 0.05f, "Share bad place", opts.share_bad_place);
+    add_new_scrollbar(box, runner, 0.0f, 1.0f, 0.05f, "Share bad distr. place", opts.share_bad_distributed_place);
+    add_new_scrollbar(box, runner, 0.0f, 1.0f, 0.05f, "Risky choices", opts.risky_choices);
+    add_new_scrollbar(box, runner, 0.0f, 1.0f, 0.05f, "Survival chance", opts.survival_chance);
+    add_new_scrollbar(box, runner, -1.f, 1.0f, 0.05f, "Good threshold", opts.good_threshold);
+    add_new_scrollbar(box, runner, -1.f, 1.0f, 0.05f, "Bad threshold", opts.bad_threshold);
+    add_new_scrollbar(box, runner, 0.0f, 150.0f, 25.f, "Share radius", opts.share_radius);
+    add_new_scrollbar(box, runner, 0.0f, 1.0f, 0.05f, "Share chance", opts.share_chance);
+    add_new_scrollbar(box, runner, 0.0f, 1.0f, 0.05f, "Repeated share chance", opts.repeated_share);
+    add_new_scrollbar(box, runner, 2.0f, 5.0f, 1.0f, "Distribute radius", opts.distribute_radius);
+    add_new_scrollbar(box, runner, 1.0f, 50.f, 5.f, "Learn time", opts.learn_time);
+    add_new_scrollbar(box, runner, 0.0f, 500.f, 25.f, "Survive without food", opts.foodless_survival);
+    add_new_scrollbar(box, runner, 1.0f, 2000.f, 25.f, "Terrain modify time [steps]", opts.terrain_modify_step);
+    add_new_scrollbar(box, runner, 1.0f, 100.0f, 5.f, "Default field value", opts.default_field_value);
+    add_new_scrollbar(box, runner, 1.0f, 1000.0f, 20.f, "Agent spawn time [steps]", opts.agent_spawn_time);
+    add_new_scrollbar(box, runner, 0.0f, 2.0f, 0.025f, "Step time [s]", opts.step_time);
+    add_new_scrollbar(box, runner, 0.0f, 1000.0f, 10.f, "Turbo steps per frame (0 - max)", opts.turbo_steps);
     
 
     // -----
@@ -360,6 +538,8 @@ int main()
 
     // -----
 
+    runner.start();
+
     sf::Clock timer;
 
     while (rw.isOpen()) {
@@ -374,30 +554,23 @@ int main()
                 rw.close();
             } else if (event.type == sf::Event::Resized) {
                 auto view = rw.getView();
-                view.setSize(sf::Vector2f(event.size.width, event.size.height));
+                view.setSize(sf::Vector2f(event.size.width * zoom, event.size.height * zoom));
                 rw.setView(view);
 
                 gui_wnd->SetRequisition(sf::Vector2f(300.0f, event.size.height));
                 //box->SetRequisition(sf::Vector2f(300.0f, event.size.height));
             } else if (change_map_opt > 0) {
                 if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
-                    int yy = event.mouseButton.y + rw.getView().getCenter().y - rw.getView().getSize().y / 2;
-                    int xx = event.mouseButton.x + rw.getView().getCenter().x - rw.getView().getSize().x / 2;
+                    auto world = rw.mapPixelToCoords(sf::Vector2i(event.mouseButton.x, event.mouseButton.y));
+                    int yy = static_cast<int>(world.y);
+                    int xx = static_cast<int>(world.x);
 
                     const double radius = std::ceil(std::sqrt(3) * 25);
                     auto hex = position_hex(radius, yy, xx);
 
-                    if (change_map_opt == 1) {
-                        map.change_field(hex, Field::Empty);
-                    } else if (change_map_opt == 2) {
-                        map.change_field(hex, Field::Food); 
-                    } else if (change_map_opt == 3) {
-                        map.change_field(hex, Field::Water);
-                    } else if (change_map_opt == 4) {
-                        map.change_field(hex, Field::Blocked);
-                    } else if (change_map_opt == 5) {
-                        map.change_field(hex, Field::Danger);
-                    }
+                    static const Field options[] = { Field::Empty, Field::Food, Field::Water, Field::Blocked, Field::Danger };
+                    Field field = options[change_map_opt - 1];
+                    runner.post([=](Simulation &, Map &_map) { _map.change_field(hex, field); });
 
                 }
             } else if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
@@ -411,19 +584,31 @@ int main()
             } else if (event.type == sf::Event::MouseMoved && drag) {
                 sf::Vector2f pos(event.mouseMove.x, event.mouseMove.y);
                 auto view = rw.getView();
-                view.move(last_pos - pos);
+                view.move((last_pos - pos) * zoom);
                 rw.setView(view);
 
                 last_pos = pos;
+            } else if (event.type == sf::Event::MouseWheelScrolled) {
+                float factor = event.mouseWheelScroll.delta > 0 ? 0.8f : 1.25f;
+                zoom *= factor;
+                auto view = rw.getView();
+                view.zoom(factor);
+                rw.setView(view);
             }
 
         }
 
         // -----
 
-        if (run_simulation && sim_timer.getElapsedTime().asSeconds() > sim.get_options().step_time) {
-            sim.step();
-            sim_timer.restart();
+        if (runner.fetch(snapshot)) {
+            sim_view.apply(snapshot);
+
+            // etykieta zmieniana tylko przy zmianie wartosci (SetText przelicza uklad okna)
+            int sps = static_cast<int>(snapshot.steps_per_second + 0.5);
+            if (sps != shown_sps) {
+                shown_sps = sps;
+                sps_label->SetText("Steps/s: " + std::to_string(sps));
+            }
         }
 
         // -----
@@ -435,7 +620,7 @@ int main()
         
         rw.clear(sf::Color::White);
 
-        rw.draw(sim);
+        rw.draw(sim_view);
 
         sfgui.Display(rw);
 
@@ -548,13 +733,27 @@ void parse_options(std::string _file_name, SimulationOptions &_opts)
                 _opts.default_field_value = from_string<unsigned int>(val);
             } else if (name == "common_knowledge") {
                 _opts.common_knowledge = from_string<unsigned int>(val);
+            } else if (name == "planner_threads") {
+                _opts.planner_threads = from_string<unsigned int>(val);
+            } else if (name == "share_threads") {
+                _opts.share_threads = from_string<unsigned int>(val);
+            } else if (name == "inherit_knowledge") {
+                _opts.inherit_knowledge = from_string<unsigned int>(val);
+            } else if (name == "knowledge_budget") {
+                _opts.knowledge_budget = from_string<unsigned int>(val);
+            } else if (name == "knowledge_eviction") {
+                _opts.knowledge_eviction = from_string<unsigned int>(val);
+            } else if (name == "path_validation") {
+                _opts.path_validation = from_string<unsigned int>(val);
+            } else if (name == "max_allocs_per_step") {
+                _opts.max_allocs_per_step = from_string<double>(val);
             }
         }
     }
 }
 
 template <typename T>
-void add_new_scrollbar(sfg::Box::Ptr _ptr, float _min, float _max, float _step, std::string const &_text, T &_opts)
+void add_new_scrollbar(sfg::Box::Ptr _ptr, SimulationRunner &_runner, float _min, float _max, float _step, std::string const &_text, T &_opts)
 {
     auto label_name = sfg::Label::Create(_text);
     auto box = sfg::Box::Create(sfg::Box::Orientation::VERTICAL);
@@ -563,10 +762,10 @@ void add_new_scrollbar(sfg::Box::Ptr _ptr, float _min, float _max, float _step,
     auto tmp_scr = sfg::Scale::Create(_min, _max, _step);
     tmp_scr->SetRequisition(sf::Vector2f(200.0f, 10.0f));
     tmp_scr->GetAdjustment()->SetValue(_opts);
-    tmp_scr->GetAdjustment()->GetSignal(sfg::Adjustment::OnChange).Connect([=, &_opts]() {
-        auto val = tmp_scr->GetAdjustment()->GetValue();
-        _opts = static_cast<T>(val);
-        tmp_label->SetText(std::to_string(_opts));
+    tmp_scr->GetAdjustment()->GetSignal(sfg::Adjustment::OnChange).Connect([=, &_runner, &_opts]() {
+        auto val = static_cast<T>(tmp_scr->GetAdjustment()->GetValue());
+        _runner.post([=, &_opts](Simulation &, Map &) { _opts = val; });
+        tmp_label->SetText(std::to_string(val));
     });
 
     auto tmp_box = sfg::Box::Create();
@@ -1,281 +1,437 @@
 #include <iterator>
+#include <cassert>
 
 #include "agent.h"
+#include "agent_store.h"
 #include "utils.h"
+#include "scratch.h"
 
-Agent::Agent(Vec2 const &_start_pos, unsigned int _id, SimulationOptions &_opts, std::shared_ptr<Knowledge> _knowledge)
-    : position(_start_pos)
-    , simulation_opts(_opts)
-    , mother_land(_start_pos)
-    , target(_start_pos)
-    , new_knowledge(0)
-    , time_alive(0)
-    , has_food(false)
-    , is_hungry(false)
-    , is_viewed(false)
-    , is_sharing(false)
-    , alive(true)
-    , id(_id)
-    , food_timer(0)
-{
-    knowledge = _knowledge;
-    if (!knowledge) {
-        knowledge = std::make_shared<Knowledge>();
+namespace
+{
+    /**
+     * Funkcja zostawia kazdy element listy z podanym prawdopodobienstwem (jedno losowanie na element,
+     * porownanie calkowitoliczbowe rownowazne next_double() < chance)
+     * @param places lista miejsc
+     * @param chance prawdopodobienstwo
+     * @param rng strumien liczb losowych
+     */
+    void keep_with_chance(std::vector<Vec2> &_places, double _chance, RandomStream &_rng)
+    {
+        const unsigned long long limit = _chance <= 0.0 ? 0 :
+                                         _chance >= 1.0 ? (1ULL << 53) : static_cast<unsigned long long>(_chance * 9007199254740992.0);
+        std::size_t kept = 0;
+        for (auto &&p : _places) {
+            if ((_rng.next() >> 11) < limit) {
+                _places[kept++] = p;
+            }
+        }
+        _places.resize(kept);
     }
+}
 
-    knowledge->values[position] = 0.0;
+Agent::Agent(AgentStore &_store, std::size_t _slot)
+    : store(&_store)
+    , slot(_slot)
+{
 }
 
-Agent::Agent(Agent &&) = default;
+// -----
 
-Agent& Agent::operator=(Agent &&) = default;
+void Agent::make_decision(Map const &_map)
+{
+    update_target(_map);
 
-Agent::~Agent() = default;
+    if (!is_path_valid(_map)) {
+        auto &path = store->paths[slot];
+        ScratchVector<Vec2> avoid_buffer;
+        auto &avoid = *avoid_buffer;
+        avoided_cells(avoid);
 
-// -----
+        int total_cost = -1;
+        _map.search_path(store->positions[slot], store->targets[slot], *store->knowledge[slot], total_cost, path, &avoid);
+        accept_path(total_cost);
+    }
 
-void Agent::make_decision(Map const &_map)
+    follow_path();
+}
+
+void Agent::update_target(Map const &_map)
 {
+    auto &target = store->targets[slot];
+    auto &position = store->positions[slot];
+
     if (target == _map.start() && target == position) {
         choose_target(_map);
     } else if (target == position) {
         target = _map.start();
     }
+}
 
-    if (!is_path_valid()) {
-        int total_cost = -1;
-        path = _map.search_path(position, target, knowledge, total_cost);
-        if (total_cost > 1000000 && random_double() < simulation_opts.risky_choices) {
-            path.clear();
+void Agent::avoided_cells(std::vector<Vec2> &_avoid)
+{
+    auto &avoided = store->path_avoids[slot];
+    _avoid.insert(_avoid.end(), avoided.begin(), avoided.end());
+    avoided.clear();
+
+    Knowledge const *own = store->knowledge[slot].get();
+    for (auto &&h : store->deferred_harmful) {
+        if (h.first == own) {
+            _avoid.push_back(h.second);
         }
     }
+}
+
+void Agent::request_path(PathPlanner &_planner)
+{
+    PathRequest request = _planner.prepare();
+    request.start = store->positions[slot];
+    request.target = store->targets[slot];
+    request.knowledge = store->knowledge[slot];
+    avoided_cells(request.avoid);
 
-    if (is_path_valid()) {
+    store->path_tickets[slot] = _planner.submit(std::move(request));
+}
+
+bool Agent::awaits_path() const
+{
+    return store->path_tickets[slot] != PathPlanner::no_ticket;
+}
+
+void Agent::wait_for_path(PathPlanner &_planner) const
+{
+    if (awaits_path()) {
+        _planner.wait_for(store->path_tickets[slot]);
+    }
+}
+
+void Agent::receive_path(std::vector<PathRequest> &_requests)
+{
+    auto &ticket = store->path_tickets[slot];
+    auto &request = _requests[ticket];
+    ticket = PathPlanner::no_ticket;
+
+    // wyszukiwanie nigdy nie prowadzi przez pola omijane (zmienione pola sciezki i odlozone zmiany wiedzy)
+    assert(std::none_of(request.path.begin(), request.path.end(), [&](Vec2 const &_p) {
+        return std::find(request.avoid.begin(), request.avoid.end(), _p) != request.avoid.end();
+    }));
+
+    store->paths[slot].swap(request.path);
+    accept_path(request.total_cost);
+}
+
+void Agent::accept_path(int _total_cost)
+{
+    if (_total_cost > 1000000 && random_double() < store->options.risky_choices) {
+        store->paths[slot].clear();
+    }
+}
+
+void Agent::follow_path()
+{
+    auto &path = store->paths[slot];
+    auto &decision = store->decisions[slot];
+
+    if (!path.empty()) {
         decision = path.back();
         path.pop_back();
     } else {
-        decision = position;
+        decision = store->positions[slot];
     }
 }
 
 Vec2 Agent::get_decision() const
 {
-    return decision;
+    return store->decisions[slot];
 }
 
 Vec2 Agent::get_position() const
 {
-    return position;
+    return store->positions[slot];
 }
 
 bool Agent::is_alive() const
 {
-    return alive;
+    return (store->flags[slot] & AgentStore::Alive) != 0;
 }
 
-void Agent::next_day()
+unsigned int Agent::lifetime() const
 {
-    ++time_alive;
+    return store->day - store->birth_days[slot];
 }
 
-unsigned int Agent::lifetime() const
+unsigned int Agent::share_timer() const
+{
+    unsigned int step = store->options.step_counter;
+    unsigned int until = store->share_until[slot];
+    return until > step ? until - step : 0;
+}
+
+void Agent::set_share_timer(unsigned int _steps)
 {
-    return time_alive;
+    unsigned int until = store->options.step_counter + _steps;
+    store->share_until[slot] = until;
+    if (_steps > 0) {
+        store->schedule(store->cooldown_events, until, slot);
+    }
+}
+
+bool Agent::starved() const
+{
+    return (store->flags[slot] & AgentStore::Starved) != 0;
 }
 
 void Agent::receive_reward(Reward &&_reward)
 {
+    auto &target = store->targets[slot];
+    auto &position = store->positions[slot];
+    auto &decision = store->decisions[slot];
+    auto &path = store->paths[slot];
+    auto &new_knowledge = store->new_knowledge[slot];
+    auto &simulation_opts = store->options;
+
+    // odczyty dotycza stanu wiedzy sprzed nagrody, a zmiany zapisywane sa jako rekordy
+    // (magazyn wprowadza je od razu lub odklada do konca ruchu agentow)
+    Knowledge const &knowledge = *store->knowledge[slot];
+    ScratchVector<Knowledge::Update> updates_buffer;
+    auto &updates = *updates_buffer;
+
     if (_reward.value > simulation_opts.good_threshold) {
-        if (knowledge->positive.find(_reward.next_position) == knowledge->positive.end()) {
-            knowledge->positive.insert(_reward.next_position);
+        if (!knowledge.has(_reward.next_position, KnowledgeTiles::Positive)) {
+            updates.push_back({ Knowledge::Update::AddPositive, _reward.next_position });
             ++new_knowledge;
         }
-        has_food = true;
-        target = mother_land;
+        store->flags[slot] |= AgentStore::HasFood;
+        target = store->homes[slot];
         path.clear();
     } else if (_reward.value < simulation_opts.bad_threshold) {
-        if (knowledge->negative.find(_reward.value) == knowledge->negative.end()) {
-            knowledge->negative.insert(_reward.next_position);
+        if (!knowledge.has(_reward.next_position, KnowledgeTiles::Negative)) {
+            updates.push_back({ Knowledge::Update::AddNegative, _reward.next_position });
             ++new_knowledge;
         }
-        target = mother_land;
+        target = store->homes[slot];
         path.clear();
     }
 
-    if (!are_same(_reward.value, knowledge->values[decision])) {
-        if (knowledge->values[decision] > simulation_opts.good_threshold && _reward.value < simulation_opts.good_threshold) {
-            knowledge->positive.erase(decision);
+    double decision_value = knowledge.value(decision);
+    if (!knowledge.has(decision, KnowledgeTiles::Known)) {
+        updates.push_back({ Knowledge::Update::Touch, decision });
+    }
+
+    if (!are_same(_reward.value, decision_value)) {
+        if (decision_value > simulation_opts.good_threshold && _reward.value < simulation_opts.good_threshold) {
+            updates.push_back({ Knowledge::Update::ErasePositive, decision });
         }
-        if (knowledge->values[decision] < simulation_opts.bad_threshold && _reward.value > simulation_opts.bad_threshold) {
-            knowledge->negative.erase(decision);
+        if (decision_value < simulation_opts.bad_threshold && _reward.value > simulation_opts.bad_threshold) {
+            updates.push_back({ Knowledge::Update::EraseNegative, decision });
         }
         ++new_knowledge;
         path.clear();
     }
 
     if (decision != _reward.next_position) {
-        knowledge->values.erase(decision);
-        knowledge->positive.erase(decision);
-        knowledge->negative.erase(decision);
+        updates.push_back({ Knowledge::Update::Forget, decision });
         path.clear();
             
-        knowledge->blocked.insert(decision);
+        updates.push_back({ Knowledge::Update::Block, decision });
     }
 
-    knowledge->values[_reward.next_position] = clamp(-1.0, 1.0, knowledge->values[_reward.next_position] + _reward.value);
-    knowledge->time_stamp[_reward.next_position] = simulation_opts.step_counter;
+    updates.push_back({ Knowledge::Update::Observe, _reward.next_position, _reward.value, simulation_opts.step_counter });
+    updates.push_back({ Knowledge::Update::Notify, decision });
+    updates.push_back({ Knowledge::Update::Notify, _reward.next_position });
+    store->update_knowledge(slot, updates);
     position = _reward.next_position;
 }
 
 void Agent::die()
 {
-    alive = false;
+    store->flags[slot] &= ~AgentStore::Alive;
 }
 
 
 int Agent::has_new_knowledge() const
 {
-    return new_knowledge;
+    return store->new_knowledge[slot];
 }
 
 
 int Agent::know_of(Vec2 const &_p) const
 {
-    if (knowledge->blocked.find(_p) != knowledge->blocked.end()) return 4;
-    if (knowledge->positive.find(_p) != knowledge->positive.end()) return 3;
-    if (knowledge->negative.find(_p) != knowledge->negative.end()) return 2;
-    if (knowledge->values.find(_p) != knowledge->values.end()) return 1;
-    return 0;
+    return store->knowledge[slot]->level(_p);
 }
 
 void Agent::set_viewed(bool _is_viewed)
 {
-    is_viewed = _is_viewed;
+    auto &f = store->flags[slot];
+    f = _is_viewed ? (f | AgentStore::Viewed) : (f & ~AgentStore::Viewed);
 }
 
 void Agent::set_share(bool _is_sharing)
 {
-    is_sharing = _is_sharing;
+    auto &f = store->flags[slot];
+    f = _is_sharing ? (f | AgentStore::Sharing) : (f & ~AgentStore::Sharing);
 }
 
 unsigned int Agent::get_id() const
 {
-    return id;
-}
-
-void Agent::increase_food_timer()
-{
-    ++food_timer;
-    is_hungry = false;
-    if (food_timer > simulation_opts.foodless_survival) {
-        die();
-    } else if (food_timer > simulation_opts.foodless_survival / 2) {
-        is_hungry = true;
-    }
+    return store->ids[slot];
 }
 
 void Agent::reset_food_timer()
 {
-    food_timer = 0;
+    store->fed_days[slot] = store->day;
 }
 
 bool Agent::starving() const
 {
-    return is_hungry;
+    return store->day - store->fed_days[slot] > store->options.foodless_survival / 2;
 }
 
 void Agent::give_food()
 {
-    has_food = true;
+    store->flags[slot] |= AgentStore::HasFood;
 }
 
 bool Agent::carrying_food() const
 {
-    return has_food;
+    return (store->flags[slot] & AgentStore::HasFood) != 0;
 }
 
 void Agent::take_food()
 {
-    has_food = false;
+    store->flags[slot] &= ~AgentStore::HasFood;
 }
 
 Knowledge const& Agent::get_knowledge() const
 {
-    return *knowledge;
+    return *store->knowledge[slot];
 }
 
 
-void Agent::share_knowledge(Agent &_other, Map &_map)
+void Agent::share_knowledge(Agent &_other, Map const &_map, RandomStream &_rng)
 {
-    std::vector<Vec2> share_positive;
-    std::vector<Vec2> share_negative;
-
-    for (auto &&p : knowledge->positive) {
-        if (knowledge->values[p] > simulation_opts.good_threshold &&
-            _other.know_of(p) != know_of(p) &&
-            _other.knowledge->time_stamp[p] < knowledge->time_stamp[p] &&
-            random_double() < simulation_opts.share_chance) {
-            share_positive.push_back(p);
+    auto &position = store->positions[slot];
+    auto &knowledge = store->knowledge[slot];
+    auto &other_knowledge = _other.store->knowledge[_other.slot];
+    auto &simulation_opts = store->options;
+
+    // bufory tymczasowe z puli watku - bez alokacji w ustalonym stanie symulacji
+    ScratchVector<Vec2> positive_buffer, negative_buffer, search_buffer, line_buffer;
+    ScratchVector<std::pair<Vec2, unsigned int>> path_buffer;
+    ScratchVector<std::pair<Vec2, double>> distributed_buffer;
+
+    auto &share_positive = *positive_buffer;
+    auto &share_negative = *negative_buffer;
+    auto &search = *search_buffer;
+    auto &line = *line_buffer;
+    auto &pth = *path_buffer;
+    auto &dis_point = *distributed_buffer;
+
+    auto shareable = [&](Vec2 const &_p) {
+        return other_knowledge->time_stamp(_p) < knowledge->time_stamp(_p);
+    };
+
+    // dobre/zle miejsce z dziennika, ktore otrzymujacy widzi inaczej
+    auto consider = [&](Vec2 const &_p) {
+        if (_other.know_of(_p) == know_of(_p) || !shareable(_p)) {
+            return;
         }
-    }
-
-    for (auto &&p : knowledge->negative) {
-        if (knowledge->values[p] < simulation_opts.bad_threshold &&
-            _other.know_of(p) != know_of(p) &&
-            _other.knowledge->time_stamp[p] < knowledge->time_stamp[p] &&
-            random_double() < simulation_opts.share_chance) {
-            share_negative.push_back(p);
+        if (knowledge->has(_p, KnowledgeTiles::Positive)) {
+            if (knowledge->value(_p) > simulation_opts.good_threshold) {
+                share_positive.push_back(_p);
+            }
+        } else if (knowledge->has(_p, KnowledgeTiles::Negative) &&
+                   knowledge->value(_p) < simulation_opts.bad_threshold) {
+            share_negative.push_back(_p);
+        }
+    };
+
+    auto &&changes = knowledge->changes();
+    std::size_t first_change = knowledge->changes_for(_other.get_id());
+    if (first_change == 0) {
+        // pierwszy kontakt - roznice wiedzy o polach mapy liczone na kafelkach (takze odziedziczonych)
+        KnowledgeTiles::share_candidates(knowledge->tiles, other_knowledge->tiles, share_positive, share_negative);
+
+        auto filter = [&](std::vector<Vec2> &_out, bool _good) {
+            std::size_t kept = 0;
+            for (auto &&p : _out) {
+                double v = knowledge->value(p);
+                if ((_good ? v > simulation_opts.good_threshold : v < simulation_opts.bad_threshold) && shareable(p)) {
+                    _out[kept++] = p;
+                }
+            }
+            _out.resize(kept);
+        };
+        filter(share_positive, true);
+        filter(share_negative, false);
+
+        if (!knowledge->covered_by_tiles()) {
+            for (auto &&c : changes) {
+                if (c.live && !knowledge->tiles.contains(c.pos)) {
+                    consider(c.pos);
+                }
+            }
+        }
+    } else {
+        // przegladane sa tylko zmiany od ostatniej wymiany z tym agentem
+        for (std::size_t i = first_change; i < changes.size(); ++i) {
+            if (changes[i].live) {
+                consider(changes[i].pos);
+            }
         }
     }
 
+    keep_with_chance(share_positive, simulation_opts.share_chance, _rng);
+    keep_with_chance(share_negative, simulation_opts.share_chance, _rng);
+    knowledge->mark_offered(_other.get_id());
+
     // -----
 
-    double share_method = random_double();
+    double share_method = _rng.next_double();
 
     // -----
 
     if (share_method < simulation_opts.share_good_path_place) {
         for (auto &&p : share_positive) {
             int tc;
-            std::vector<std::pair<Vec2, unsigned int>> pth;
-            auto search = _map.search_path(position, p, knowledge, tc);
+            pth.clear();
+            _map.search_path(position, p, *knowledge, tc, search);
             std::transform(search.begin(), search.end(), std::back_inserter(pth), [=](auto &&_a) {
-                return std::make_pair(_a, knowledge->time_stamp[_a]);
+                return std::make_pair(_a, knowledge->time_stamp(_a));
             });
             _other.consume_path(pth);
-            _other.consume_place(p, knowledge->values[p], knowledge->time_stamp[p]);
+            _other.consume_place(p, knowledge->value(p), knowledge->time_stamp(p));
         }
 
     } else if (share_method < simulation_opts.share_good_path) {
         for (auto &&p : share_positive) {
             int tc;
-            std::vector<std::pair<Vec2, unsigned int>> pth;
-            auto search = _map.search_path(position, p, knowledge, tc);
+            pth.clear();
+            _map.search_path(position, p, *knowledge, tc, search);
             std::transform(search.begin(), search.end(), std::back_inserter(pth), [=](auto &&_a) {
-                return std::make_pair(_a, knowledge->time_stamp[_a]);
+                return std::make_pair(_a, knowledge->time_stamp(_a));
             });
             _other.consume_path(pth);
         }
 
     } else if (share_method < simulation_opts.share_good_place) {
         for (auto &&p : share_positive) {
-            _other.consume_place(p, knowledge->values[p], knowledge->time_stamp[p]);
+            _other.consume_place(p, knowledge->value(p), knowledge->time_stamp(p));
         }
 
     } else if (share_method < simulation_opts.share_good_distributed_place) {
         for (auto &&p : share_positive) {
-            auto dis_point = distribute_point(p, random_int(1, simulation_opts.distribute_radius), knowledge->values[p]);
+            distribute_point(p, _rng.next_int(1, simulation_opts.distribute_radius), knowledge->value(p), dis_point);
             for (auto &&d : dis_point) {
-                _other.consume_place(d.first, d.second, knowledge->time_stamp[p]);
+                _other.consume_place(d.first, d.second, knowledge->time_stamp(p));
             }
         }
 
     } else if (share_method < simulation_opts.share_good_direction) {
         for (auto &&p : share_positive) {
-            std::vector<std::pair<Vec2, unsigned int>> pth;
-            auto line = on_line(position, p);
+            pth.clear();
+            on_line(position, p, line);
             std::transform(line.begin(), line.end(), std::back_inserter(pth), [=](auto &&_a) {
-                return std::make_pair(_a, knowledge->time_stamp[p]);
+                return std::make_pair(_a, knowledge->time_stamp(p));
             });
             _other.consume_path(pth);
         }
@@ -283,20 +439,20 @@ void Agent::share_knowledge(Agent &_other, Map &_map)
 
     // -----
 
-    share_method = random_double();
+    share_method = _rng.next_double();
 
     // -----
 
     if (share_method < simulation_opts.share_bad_place) {
         for (auto &&p : share_negative) {
-            _other.consume_place(p, knowledge->values[p], knowledge->time_stamp[p]);
+            _other.consume_place(p, knowledge->value(p), knowledge->time_stamp(p));
         }
 
     } else if (share_method < simulation_opts.share_bad_distributed_place) {
         for (auto &&p : share_negative) {
-            auto dis_point = distribute_point(p, random_int(1, simulation_opts.distribute_radius), knowledge->values[p]);
+            distribute_point(p, _rng.next_int(1, simulation_opts.distribute_radius), knowledge->value(p), dis_point);
             for (auto &&d : dis_point) {
-                _other.consume_place(d.first, d.second, knowledge->time_stamp[p]);
+                _other.consume_place(d.first, d.second, knowledge->time_stamp(p));
             }
         }
 
@@ -305,51 +461,49 @@ void Agent::share_knowledge(Agent &_other, Map &_map)
 
 void Agent::consume_path(std::vector<std::pair<Vec2, unsigned int>> const &_path)
 {
+    auto &knowledge = store->knowledge[slot];
     for (auto &&p : _path) {
-        volatile auto v = knowledge->values[p.first];
-        knowledge->time_stamp[p.first] = p.second;
+        knowledge->touch(p.first);
+        knowledge->set_time_stamp(p.first, p.second);
+        knowledge->notify(p.first);
     }
 }
 
 void Agent::consume_place(Vec2 const &_place, double _val, unsigned int _time_stamp)
 {
-    auto &val = knowledge->values[_place];
-    val += _val;
-    val = clamp(-1.0, 1.0, val);
+    auto &knowledge = store->knowledge[slot];
+    auto &simulation_opts = store->options;
+
+    double val = clamp(-1.0, 1.0, knowledge->value(_place) + _val);
+    knowledge->set_value(_place, val);
 
     if (val > simulation_opts.good_threshold) {
-        knowledge->positive.insert(_place);
-        knowledge->negative.erase(_place);
-        knowledge->time_stamp[_place] = _time_stamp;
+        knowledge->set(_place, KnowledgeTiles::Positive, true);
+        knowledge->set(_place, KnowledgeTiles::Negative, false);
+        knowledge->set_time_stamp(_place, _time_stamp);
     } else if (val < simulation_opts.bad_threshold) {
-        knowledge->negative.insert(_place);
-        knowledge->positive.erase(_place);
-        knowledge->time_stamp[_place] = _time_stamp;
+        knowledge->set(_place, KnowledgeTiles::Negative, true);
+        knowledge->set(_place, KnowledgeTiles::Positive, false);
+        knowledge->set_time_stamp(_place, _time_stamp);
     }
+    knowledge->notify(_place);
 }
 
-void Agent::draw(sf::RenderTarget &_target, sf::RenderStates _states) const
+AgentSprite Agent::sprite() const
 {
-    const double radius = std::ceil(std::sqrt(3) * 25);
-    auto pos = hex_position(radius, position);
-    pos.x += 15.0f; pos.y += 15.0f;
-
-    sf::CircleShape shp(10);
-    shp.setFillColor(is_sharing ? sf::Color(255, 215, 0) : (is_viewed ? sf::Color(176, 86, 232) : sf::Color(149, 238, 255)));
-    shp.setPosition(pos);
-
-    _target.draw(shp, _states);
+    auto f = store->flags[slot];
+    return AgentSprite{ store->positions[slot], (f & AgentStore::Sharing) ? AgentSprite::Sharing :
+                                                ((f & AgentStore::Viewed) ? AgentSprite::Viewed : AgentSprite::Normal) };
 }
 
 void Agent::choose_target(Map const &_map)
 {
-    std::vector<Vec2> choices;
-    for (auto &&p : knowledge->positive) {
-        if (knowledge->values[p] > simulation_opts.target_threshold) {
-            choices.push_back(p);
-        }
-    }
-    
+    auto &target = store->targets[slot];
+    auto &knowledge = store->knowledge[slot];
+    auto &simulation_opts = store->options;
+
+    auto const &choices = knowledge->targets(simulation_opts.target_threshold);
+
     if (choices.empty()) {
         Vec2 dim = _map.dimensions();
         target.x = random_int(0, dim.x - 1);
@@ -359,7 +513,38 @@ void Agent::choose_target(Map const &_map)
     }
 }
 
-bool Agent::is_path_valid()
+bool Agent::is_path_valid(Map const &_map)
 {
+    auto &path = store->paths[slot];
+    auto &checked = store->path_epochs[slot];
+
+    if (path.empty() || !store->options.path_validation || checked == _map.epoch()) {
+        checked = _map.epoch();
+        return !path.empty();
+    }
+
+    auto harmful = [](Field _field) { return _field == Field::Blocked || _field == Field::Danger; };
+
+    // zwykle zmiany dotycza jedzenia i wody - wtedy wystarczy przejrzec dziennik
+    bool harmful_changes = false;
+    bool journaled = _map.changes_since(checked, [&](FieldChange const &_change) {
+        harmful_changes = harmful_changes || harmful(_change.field);
+    });
+
+    // zmienione pola omija jedynie ponowne wyszukiwanie - wiedza agenta zmienia sie dopiero po ich odwiedzeniu
+    if (!journaled || harmful_changes) {
+        auto &avoided = store->path_avoids[slot];
+        const std::size_t known_avoided = avoided.size();
+        for (auto &&p : path) {
+            if (_map.modified_at(p) > checked && harmful(_map.get_field(p))) {
+                avoided.push_back(p);
+            }
+        }
+        if (avoided.size() != known_avoided) {
+            path.clear();
+        }
+    }
+
+    checked = _map.epoch();
     return !path.empty();
 }
\ No newline at end of file
@@ -5,52 +5,89 @@
 #include "utils.h"
 #include "simulation_options.h"
 #include "knowledge.h"
-
-#include <SFML\Graphics.hpp>
+#include "agent_renderer.h"
+#include "path_planner.h"
 
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 #include <memory>
 
+class AgentStore;
+
 /**
- * Klasa odpowiedzialna za obiekt agenta
+ * Klasa odpowiedzialna za obiekt agenta.
+ * Dane agenta przechowywane sa w AgentStore - obiekt Agent to lekki uchwyt (magazyn + indeks),
+ * wazny do czasu usuniecia martwych agentow z magazynu.
  */
-class Agent : public sf::Drawable
+class Agent
 {
 public:
     /**
-     * Konstruktor obiektu typu Agent
-     * @param pos pozycja startowa
-     * @param id id agenta
-     * @param opts opcje symulacji
-     * @param knowledge wiedza agenta
+     * Konstruktor uchwytu agenta
+     * @param store magazyn agentow
+     * @param slot indeks agenta w magazynie
      */
-    Agent(Vec2 const &, unsigned int, SimulationOptions &, std::shared_ptr<Knowledge> _knowledge = nullptr);
+    Agent(AgentStore &, std::size_t);
+
+    // -----
     
     /**
-     * Konstruktor przenoszacy
-     * @param other
+     * Metoda ktora pozwala agentowi dokonac decyzji gdzie pojsc dalej
+     * @param map mapa
+     */
+    void make_decision(Map const &);
+
+    /**
+     * Metoda aktualizuje cel agenta (wybiera nowy cel lub powrot do domu po osiagnieciu celu)
+     * @param map mapa
      */
-    Agent(Agent &&);
+    void update_target(Map const &);
 
     /**
-     * Operator przypisania 
+     * Metoda zleca planerowi wyznaczenie sciezki do aktualnego celu agenta (wynik odbierany przez receive_path)
+     * @param planner planer sciezek
      */
-    Agent& operator=(Agent &&);
+    void request_path(PathPlanner &);
 
     /**
-     * Destruktor obiektu Agent
+     * Metoda sprawdza czy agent czeka na wynik zlecenia planera
+     * @return informacja czy agent czeka na sciezke
      */
-    virtual ~Agent();
+    bool awaits_path() const;
 
-    // -----
-    
     /**
-     * Metoda ktora pozwala agentowi dokonac decyzji gdzie pojsc dalej
+     * Metoda czeka na wykonanie zlecenia agenta (np. przed zmiana jego wiedzy), bez odbierania wyniku
+     * @param planner planer sciezek
+     */
+    void wait_for_path(PathPlanner &) const;
+
+    /**
+     * Metoda odbiera wynik zlecenia agenta i pozwala go przyjac lub odrzucic (bufor sciezki jest zamieniany)
+     * @param requests wykonane zlecenia planera
+     */
+    void receive_path(std::vector<PathRequest> &);
+
+    /**
+     * Metoda pozwala agentowi przyjac lub odrzucic wyznaczona sciezke
+     * @param total_cost koszt sciezki
+     */
+    void accept_path(int);
+
+    /**
+     * Metoda ustawia decyzje na kolejny krok sciezki (lub pozostanie w miejscu gdy sciezki brak)
+     */
+    void follow_path();
+
+    /**
+     * Metoda sprawdza czy aktualna sciezka jest wciaz wazna. Przy sprawdzaniu sciezek porzucana jest sciezka
+     * przechodzaca przez pole zmienione od jej wyznaczenia na zablokowane lub niebezpieczne - ponowne wyszukiwanie
+     * omija to pole, a wiedza agenta nie jest zmieniana (agent nie odwiedzil pola).
+     * Zmiany sprawdzane sa dziennikiem mapy, a gdy sa wsrod nich takie pola - epokami pol sciezki.
      * @param map mapa
+     * @return waznosc sciezki (brak sciezki oznacza jej wyznaczenie dla obecnego stanu mapy)
      */
-    void make_decision(Map const &);
+    bool is_path_valid(Map const &);
 
     /**
      * Metoda zwracajaca podjeta przez agenta decyzje
@@ -82,11 +119,13 @@ public:
     bool is_alive() const;
 
     /**
-     * Metoda pozwala agentowi podzielic sie wiedza z innym agentem
+     * Metoda pozwala agentowi podzielic sie wiedza z innym agentem (zmieniana jest tylko wiedza otrzymujacego,
+     * wiec rozlaczne pary moga wymieniac wiedze jednoczesnie)
      * @param agent agent ktoremu przekazywana jest wiedza
      * @param map mapa potrzebna do wyznaczania sciezek
+     * @param rng strumien liczb losowych wymiany
      */
-    void share_knowledge(Agent &, Map &);
+    void share_knowledge(Agent &, Map const &, RandomStream &);
 
     /**
      * Metoda zwracajaca informacje czy agent dowiedzial sie czegos nowego
@@ -119,11 +158,6 @@ public:
      */
     unsigned int get_id() const;
 
-    /**
-     * Metoda zwieksza wskaznik glodu agenta
-     */
-    void increase_food_timer();
-
     /**
      * Metoda resetuje wskaznik glodu agenta
      */
@@ -151,17 +185,30 @@ public:
      */
     void take_food();
     
-    /**
-     * Metoda aktualizuje czas zycia danego agenta
-     */
-    void next_day();
-
     /**
      * Metoda pobiera czas zycia danego agenta
      * @return czas zycia agenta
      */
     unsigned int lifetime() const;
 
+    /**
+     * Metoda zwraca ilosc krokow pozostalych do konca wymiany wiedzy
+     * @return ilosc krokow (0 - agent nie wymienia wiedzy)
+     */
+    unsigned int share_timer() const;
+
+    /**
+     * Metoda ustawia czas wymiany wiedzy
+     * @param steps ilosc krokow
+     */
+    void set_share_timer(unsigned int);
+
+    /**
+     * Metoda zwraca informacje czy agent zmarl z glodu w ostatnim kroku
+     * @return informacja o smierci z glodu
+     */
+    bool starved() const;
+
     // -----
 
     /**
@@ -170,11 +217,11 @@ public:
      */
     Knowledge const& get_knowledge() const;
 
-    // -----
     /**
-     * Metoda z biblioteki SFML sluzaca do rysowania na oknie
+     * Metoda zwraca opis agenta potrzebny do jego narysowania
+     * @return pozycja i stan agenta
      */
-    virtual void draw(sf::RenderTarget &_target, sf::RenderStates _states) const override; 
+    AgentSprite sprite() const;
 
 protected:
     /**
@@ -183,12 +230,6 @@ protected:
      */
     void choose_target(Map const &);
 
-    /**
-     * Metoda sprawdza czy aktualna sciezka jest wziac wazna
-     * @return waznosc sciezki
-     */
-    bool is_path_valid();
-
     /**
      * Metoda pozwala na dodanie podanej sciezki do wiedzy agenta
      * @param path sciezka
@@ -202,29 +243,16 @@ protected:
      * @param time_stamp znacznik czasowy wiedzy
      */
     void consume_place(Vec2 const &, double, unsigned int);
+
+    /**
+     * Metoda dopisuje pola, ktore wyszukiwanie sciezki ma omijac mimo wiedzy agenta - pola porzuconej
+     * sciezki zmienione na zablokowane lub niebezpieczne (tylko do najblizszego wyszukiwania) oraz
+     * odlozone zmiany jego wiedzy oznaczajace pola zablokowane i niebezpieczne
+     * @param out avoid pola omijane
+     */
+    void avoided_cells(std::vector<Vec2> &);
     
 private:
-
-    std::shared_ptr<Knowledge> knowledge;
-
-    bool                alive;
-    Vec2                target;
-    Vec2                position;
-    std::vector<Vec2>   path;
-
-    Vec2                mother_land;
-    Vec2                decision;
-    int                 new_knowledge;
-    unsigned int        time_alive;
-
-    bool                has_food;
-    bool                is_hungry;
-    bool                is_viewed;
-    bool                is_sharing;
-    unsigned int        food_timer;
-    unsigned int        id;
-
-    // -----
-
-    SimulationOptions   &simulation_opts;
+    AgentStore  *store;
+    std::size_t slot;
 };
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "agent_renderer.h"
+
+#include <cmath>
+
+namespace
+{
+    const int circle_size = 32;
+}
+
+AgentRenderer::AgentRenderer()
+    : vertices(sf::Triangles)
+{
+}
+
+void AgentRenderer::create_texture()
+{
+    // tekstura kola z wygladzona krawedzia, kolor nadawany jest przez wierzcholki
+    sf::Image image;
+    image.create(circle_size, circle_size, sf::Color::Transparent);
+    const float center = circle_size / 2.0f;
+    for (int y = 0; y < circle_size; ++y) {
+        for (int x = 0; x < circle_size; ++x) {
+            float dx = x + 0.5f - center, dy = y + 0.5f - center;
+            float alpha = clamp(0.0, 1.0, center - std::sqrt(dx * dx + dy * dy));
+            image.setPixel(x, y, sf::Color(255, 255, 255, static_cast<sf::Uint8>(alpha * 255.0f)));
+        }
+    }
+    circle.loadFromImage(image);
+    circle.setSmooth(true);
+}
+
+void AgentRenderer::update(std::vector<AgentSprite> const &_sprites)
+{
+    static const sf::Color colors[] = {
+        sf::Color(149, 238, 255),
+        sf::Color(255, 215, 0),
+        sf::Color(176, 86, 232),
+    };
+
+    if (circle.getSize().x == 0) {
+        create_texture();
+    }
+
+    const double radius = std::ceil(std::sqrt(3) * 25);
+    const float size = 20.0f, tex = static_cast<float>(circle_size);
+
+    vertices.resize(_sprites.size() * 6);
+    for (std::size_t i = 0; i < _sprites.size(); ++i) {
+        Vec2 pos = hex_position(radius, _sprites[i].position);
+        float x = pos.x + 15.0f, y = pos.y + 15.0f;
+        sf::Color color = colors[_sprites[i].state];
+
+        sf::Vertex *quad = &vertices[i * 6];
+        quad[0] = sf::Vertex(sf::Vector2f(x, y), color, sf::Vector2f(0.0f, 0.0f));
+        quad[1] = sf::Vertex(sf::Vector2f(x + size, y), color, sf::Vector2f(tex, 0.0f));
+        quad[2] = sf::Vertex(sf::Vector2f(x + size, y + size), color, sf::Vector2f(tex, tex));
+        quad[3] = quad[0];
+        quad[4] = quad[2];
+        quad[5] = sf::Vertex(sf::Vector2f(x, y + size), color, sf::Vector2f(0.0f, tex));
+    }
+}
+
+void AgentRenderer::draw(sf::RenderTarget &_target, sf::RenderStates _states) const
+{
+    if (vertices.getVertexCount() == 0) {
+        return;
+    }
+    _states.texture = &circle;
+    _target.draw(vertices, _states);
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+
+#include <SFML\Graphics.hpp>
+#include "utils.h"
+
+/**
+ * Struktura opisujaca agenta na potrzeby rysowania
+ */
+struct AgentSprite
+{
+    enum State : unsigned char
+    {
+        Normal,
+        Sharing,
+        Viewed,
+    };
+
+    Vec2    position;
+    State   state;
+};
+
+/**
+ * Klasa odpowiedzialna za rysowanie wszystkich agentow jednym wywolaniem.
+ * Kazdy agent to prostokat z tekstura kola zabarwiony kolorem zaleznym od stanu agenta.
+ */
+class AgentRenderer : public sf::Drawable
+{
+public:
+    /**
+     * Konstruktor klasy
+     */
+    AgentRenderer();
+
+    /**
+     * Metoda odbudowuje tablice wierzcholkow na podstawie bufora agentow
+     * @param sprites bufor z pozycjami i stanami agentow
+     */
+    void update(std::vector<AgentSprite> const &);
+
+    /**
+     * Metoda z biblioteki SFML sluzaca do rysowania na oknie
+     */
+    virtual void draw(sf::RenderTarget &, sf::RenderStates) const override;
+
+protected:
+    /**
+     * Metoda tworzy teksture kola (tworzona przy pierwszym uzyciu, gdy istnieje juz kontekst okna)
+     */
+    void create_texture();
+
+private:
+    sf::VertexArray vertices;
+    sf::Texture     circle;
+};
\ No newline at end of file
@@ -0,0 +1,264 @@
+#include "agent_store.h"
+
+#include <utility>
+
+AgentStore::AgentStore(SimulationOptions &_opts, Vec2 const &_dimensions)
+    : options(_opts)
+    , dimensions(_dimensions)
+    , count(0)
+    , day(0)
+    , deferring(false)
+{
+}
+
+std::size_t AgentStore::spawn(Vec2 const &_pos, unsigned int _id, std::shared_ptr<Knowledge> _knowledge)
+{
+    if (count == ids.size()) {
+        ids.emplace_back();
+        handles.emplace_back();
+        flags.emplace_back();
+        positions.emplace_back();
+        decisions.emplace_back();
+        targets.emplace_back();
+        homes.emplace_back();
+        fed_days.emplace_back();
+        birth_days.emplace_back();
+        share_until.emplace_back();
+        new_knowledge.emplace_back();
+        knowledge.emplace_back();
+        paths.emplace_back();
+        path_epochs.emplace_back();
+        path_tickets.emplace_back();
+        path_avoids.emplace_back();
+    }
+
+    std::size_t slot = count++;
+
+    unsigned int index;
+    if (free_handles.empty()) {
+        index = static_cast<unsigned int>(slot_of.size());
+        slot_of.push_back(0);
+        generations.push_back(0);
+    } else {
+        index = free_handles.back();
+        free_handles.pop_back();
+    }
+    slot_of[index] = static_cast<unsigned int>(slot);
+    handles[slot] = index;
+
+    ids[slot] = _id;
+    flags[slot] = Alive;
+    positions[slot] = _pos;
+    decisions[slot] = _pos;
+    targets[slot] = _pos;
+    homes[slot] = _pos;
+    fed_days[slot] = day;
+    birth_days[slot] = day;
+    share_until[slot] = 0;
+    new_knowledge[slot] = 0;
+    paths[slot].clear();
+    path_epochs[slot] = 0;
+    path_tickets[slot] = PathPlanner::no_ticket;
+    path_avoids[slot].clear();
+
+    knowledge[slot] = _knowledge ? _knowledge : std::make_shared<Knowledge>(dimensions);
+    if (!options.common_knowledge) {
+        knowledge[slot]->set_budget(options.knowledge_budget, options.knowledge_eviction == 1);
+    }
+    knowledge[slot]->set_value(_pos, 0.0);
+    knowledge[slot]->notify(_pos);
+
+    schedule(starvation_events, day, slot);
+    return slot;
+}
+
+std::size_t AgentStore::size() const
+{
+    return count;
+}
+
+Agent AgentStore::operator[](std::size_t _slot)
+{
+    return Agent(*this, _slot);
+}
+
+Agent const AgentStore::operator[](std::size_t _slot) const
+{
+    return Agent(const_cast<AgentStore &>(*this), _slot);
+}
+
+AgentStore::const_iterator AgentStore::begin() const
+{
+    return const_iterator(this, 0);
+}
+
+AgentStore::const_iterator AgentStore::end() const
+{
+    return const_iterator(this, count);
+}
+
+AgentHandle AgentStore::handle(std::size_t _slot) const
+{
+    AgentHandle h;
+    h.index = handles[_slot];
+    h.generation = generations[h.index];
+    return h;
+}
+
+bool AgentStore::valid(AgentHandle const &_handle) const
+{
+    return _handle.index < generations.size() && generations[_handle.index] == _handle.generation;
+}
+
+std::size_t AgentStore::slot(AgentHandle const &_handle) const
+{
+    return slot_of[_handle.index];
+}
+
+// -----
+
+void AgentStore::begin_step(unsigned int _step)
+{
+    while (!cooldown_events.empty() && cooldown_events.front().time <= _step) {
+        std::pop_heap(cooldown_events.begin(), cooldown_events.end());
+        TimedEvent e = cooldown_events.back();
+        cooldown_events.pop_back();
+
+        if (e.generation == generations[e.handle]) {
+            flags[slot_of[e.handle]] &= ~Sharing;
+        }
+    }
+}
+
+std::size_t AgentStore::next_day()
+{
+    ++day;
+
+    // agent umiera gdy od posilku minelo wiecej niz foodless_survival dni - kolejka uporzadkowana jest
+    // wg dnia posilku, wiec kolejnosc nie zalezy od (zmienialnego) limitu
+    const unsigned int limit = options.foodless_survival;
+    std::size_t starved = 0;
+
+    while (!starvation_events.empty() && starvation_events.front().time + limit < day) {
+        std::pop_heap(starvation_events.begin(), starvation_events.end());
+        TimedEvent e = starvation_events.back();
+        starvation_events.pop_back();
+
+        if (e.generation != generations[e.handle]) {
+            continue;
+        }
+        std::size_t i = slot_of[e.handle];
+        if (fed_days[i] != e.time) {
+            // agent jadl od czasu zaplanowania zdarzenia
+            schedule(starvation_events, fed_days[i], i);
+        } else if (flags[i] & Alive) {
+            flags[i] = (flags[i] & ~Alive) | Starved;
+            ++starved;
+        }
+    }
+    return starved;
+}
+
+unsigned int AgentStore::today() const
+{
+    return day;
+}
+
+Knowledge::Usage AgentStore::knowledge_usage() const
+{
+    // wspolna wiedza liczona jest raz
+    Knowledge::Usage total;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (i == 0 || knowledge[i] != knowledge[0]) {
+            total += knowledge[i]->usage();
+        }
+    }
+    return total;
+}
+
+void AgentStore::defer_knowledge_updates(bool _defer)
+{
+    deferring = _defer;
+}
+
+void AgentStore::apply_knowledge_updates()
+{
+    for (auto &&u : deferred_updates) {
+        u.first->apply(u.second);
+    }
+    deferred_updates.clear();
+    deferred_harmful.clear();
+}
+
+void AgentStore::remove(std::size_t _slot)
+{
+    // uchwyt usuwanego agenta traci waznosc
+    unsigned int index = handles[_slot];
+    ++generations[index];
+    free_handles.push_back(index);
+
+    std::size_t last = count - 1;
+    if (_slot != last) {
+        ids[_slot] = ids[last];
+        handles[_slot] = handles[last];
+        flags[_slot] = flags[last];
+        positions[_slot] = positions[last];
+        decisions[_slot] = decisions[last];
+        targets[_slot] = targets[last];
+        homes[_slot] = homes[last];
+        fed_days[_slot] = fed_days[last];
+        birth_days[_slot] = birth_days[last];
+        share_until[_slot] = share_until[last];
+        new_knowledge[_slot] = new_knowledge[last];
+        knowledge[_slot].swap(knowledge[last]);
+
+        // bufory sciezek sa zamieniane, wiec zostaja w tablicy do ponownego uzycia
+        paths[_slot].swap(paths[last]);
+        path_epochs[_slot] = path_epochs[last];
+        path_tickets[_slot] = path_tickets[last];
+        path_avoids[_slot].swap(path_avoids[last]);
+
+        slot_of[handles[_slot]] = static_cast<unsigned int>(_slot);
+    }
+
+    knowledge[last].reset();
+    count = last;
+}
+
+std::size_t AgentStore::remove_dead()
+{
+    std::size_t removed = 0;
+    for (std::size_t i = 0; i < count; ) {
+        if (flags[i] & Alive) {
+            ++i;
+        } else {
+            remove(i);
+            ++removed;
+        }
+    }
+    return removed;
+}
+
+void AgentStore::schedule(std::vector<TimedEvent> &_queue, unsigned int _time, std::size_t _slot)
+{
+    unsigned int index = handles[_slot];
+    _queue.push_back(TimedEvent{ _time, index, generations[index] });
+    std::push_heap(_queue.begin(), _queue.end());
+}
+
+void AgentStore::update_knowledge(std::size_t _slot, std::vector<Knowledge::Update> const &_updates)
+{
+    Knowledge *target = knowledge[_slot].get();
+    if (deferring) {
+        for (auto &&u : _updates) {
+            deferred_updates.emplace_back(target, u);
+            if (u.kind == Knowledge::Update::Block || u.kind == Knowledge::Update::AddNegative) {
+                deferred_harmful.emplace_back(target, u.pos);
+            }
+        }
+    } else {
+        for (auto &&u : _updates) {
+            target->apply(u);
+        }
+    }
+}
\ No newline at end of file
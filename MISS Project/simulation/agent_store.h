@@ -0,0 +1,241 @@
+#pragma once
+
+#include "agent.h"
+#include "knowledge.h"
+#include "simulation_options.h"
+#include "utils.h"
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+/**
+ * Trwaly uchwyt agenta - pozostaje wazny mimo przestawiania agentow w magazynie,
+ * a po smierci agenta przestaje byc wazny (zmiana generacji).
+ */
+struct AgentHandle
+{
+    static const unsigned int invalid = ~0u;
+
+    unsigned int index = invalid;
+    unsigned int generation = 0;
+};
+
+/**
+ * Klasa przechowujaca wszystkich agentow symulacji w rownoleglych tablicach (struktura tablic).
+ * Agent o indeksie i to i-ty element kazdej z tablic, a obiekt Agent jest jedynie uchwytem
+ * (magazyn + indeks) waznym do najblizszego usuniecia agentow. Do dluzszego przechowywania sluzy AgentHandle.
+ * Usuniecie agenta przenosi na jego miejsce ostatniego agenta (staly koszt), a tablice nigdy sie
+ * nie zmniejszaja - zwolnione miejsca (wraz z buforami sciezek) sa wykorzystywane ponownie.
+ * Liczniki czasu przechowywane sa jako chwile zdarzen, wiec krok nie przeglada wszystkich agentow -
+ * agenci wymagajacy obslugi pobierani sa z kolejek zdarzen.
+ */
+class AgentStore
+{
+public:
+    /**
+     * Flagi stanu agenta
+     */
+    enum Flags : unsigned char
+    {
+        Alive   = 1 << 0,
+        HasFood = 1 << 1,
+        Viewed  = 1 << 2,
+        Sharing = 1 << 3,
+        Starved = 1 << 4,   // agent zmarl z glodu w ostatnim kroku
+    };
+
+    /**
+     * Iterator po agentach (zwraca uchwyty)
+     */
+    class const_iterator
+    {
+    public:
+        const_iterator(AgentStore const *_store, std::size_t _slot) : store(_store), slot(_slot) {}
+
+        Agent const operator*() const { return (*store)[slot]; }
+        const_iterator& operator++() { ++slot; return *this; }
+        bool operator!=(const_iterator const &_other) const { return slot != _other.slot; }
+
+    private:
+        AgentStore const    *store;
+        std::size_t         slot;
+    };
+
+    /**
+     * Konstruktor
+     * @param opts opcje symulacji
+     * @param dimensions wymiary mapy (dla wiedzy agentow)
+     */
+    AgentStore(SimulationOptions &, Vec2 const &);
+
+    AgentStore(AgentStore const &) = delete;
+    AgentStore& operator=(AgentStore const &) = delete;
+
+    /**
+     * Metoda dodaje nowego agenta
+     * @param pos pozycja startowa
+     * @param id id agenta
+     * @param knowledge wiedza agenta (nullptr - agent dostaje wlasna wiedze)
+     * @return indeks agenta
+     */
+    std::size_t spawn(Vec2 const &, unsigned int, std::shared_ptr<Knowledge> = nullptr);
+
+    /**
+     * Metoda zwraca ilosc agentow
+     * @return ilosc agentow
+     */
+    std::size_t size() const;
+
+    /**
+     * Operator zwracajacy uchwyt agenta
+     * @param slot indeks agenta
+     * @return uchwyt agenta
+     */
+    Agent operator[](std::size_t);
+    Agent const operator[](std::size_t) const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    /**
+     * Metoda zwraca trwaly uchwyt agenta
+     * @param slot indeks agenta
+     * @return uchwyt
+     */
+    AgentHandle handle(std::size_t) const;
+
+    /**
+     * Metoda sprawdza czy agent o danym uchwycie wciaz istnieje
+     * @param handle uchwyt
+     * @return informacja czy uchwyt jest wazny
+     */
+    bool valid(AgentHandle const &) const;
+
+    /**
+     * Metoda zwraca aktualny indeks agenta (tylko dla waznego uchwytu)
+     * @param handle uchwyt
+     * @return indeks agenta
+     */
+    std::size_t slot(AgentHandle const &) const;
+
+    // -----
+
+    /**
+     * Metoda obsluguje agentow, ktorym w danym kroku konczy sie wymiana wiedzy
+     * @param step numer kroku
+     */
+    void begin_step(unsigned int);
+
+    /**
+     * Metoda rozpoczyna kolejny dzien - glod i czas zycia liczone sa od numeru dnia,
+     * wiec obslugiwani sa jedynie agenci, ktorzy umieraja z glodu (oznaczani flaga Starved)
+     * @return ilosc agentow zmarlych z glodu
+     */
+    std::size_t next_day();
+
+    /**
+     * Metoda zwraca numer aktualnego dnia
+     * @return ilosc dni od powstania magazynu
+     */
+    unsigned int today() const;
+
+    /**
+     * Metoda zwraca laczne zuzycie pamieci przez wiedze agentow
+     * @return zuzycie pamieci
+     */
+    Knowledge::Usage knowledge_usage() const;
+
+    /**
+     * Metoda wlacza/wylacza odkladanie zmian wiedzy wynikajacych z nagrod - odlozone zmiany
+     * wprowadzane sa w kolejnosci ruchu agentow przez apply_knowledge_updates, a do tego czasu
+     * wiedza moze byc bezpiecznie czytana przez inne watki. Odczyty wiedzy nie widza odlozonych zmian -
+     * jedynie odlozone pola zablokowane i niebezpieczne omijane sa przez kolejne wyszukiwania sciezek.
+     * @param defer informacja czy zmiany maja byc odkladane
+     */
+    void defer_knowledge_updates(bool);
+
+    /**
+     * Metoda wprowadza odlozone zmiany wiedzy
+     */
+    void apply_knowledge_updates();
+
+    /**
+     * Metoda usuwa agenta przenoszac na jego miejsce ostatniego agenta
+     * @param slot indeks agenta
+     */
+    void remove(std::size_t);
+
+    /**
+     * Metoda usuwa martwych agentow (kolejnosc pozostalych moze sie zmienic)
+     * @return ilosc usunietych agentow
+     */
+    std::size_t remove_dead();
+
+private:
+    friend class Agent;
+
+    /**
+     * Zdarzenie zaplanowane dla agenta (kolejka priorytetowa wg czasu)
+     */
+    struct TimedEvent
+    {
+        unsigned int time;
+        unsigned int handle;
+        unsigned int generation;
+
+        bool operator<(TimedEvent const &_other) const { return time > _other.time; }
+    };
+
+    /**
+     * Metoda dodaje zdarzenie do kolejki
+     * @param queue kolejka zdarzen
+     * @param time czas zdarzenia
+     * @param slot indeks agenta
+     */
+    void schedule(std::vector<TimedEvent> &, unsigned int, std::size_t);
+
+    /**
+     * Metoda wprowadza (lub odklada) zmiany wiedzy agenta
+     * @param slot indeks agenta
+     * @param updates zmiany w kolejnosci wprowadzania
+     */
+    void update_knowledge(std::size_t, std::vector<Knowledge::Update> const &);
+
+    SimulationOptions   &options;
+    Vec2                dimensions;
+    std::size_t         count;
+    unsigned int        day;
+
+    std::vector<unsigned int>   ids;
+    std::vector<unsigned int>   handles;
+    std::vector<unsigned char>  flags;
+    std::vector<Vec2>           positions;
+    std::vector<Vec2>           decisions;
+    std::vector<Vec2>           targets;
+    std::vector<Vec2>           homes;
+    std::vector<unsigned int>   fed_days;       // dzien ostatniego posilku
+    std::vector<unsigned int>   birth_days;
+    std::vector<unsigned int>   share_until;    // krok zakonczenia wymiany wiedzy
+    std::vector<int>            new_knowledge;
+
+    std::vector<std::shared_ptr<Knowledge>> knowledge;
+    std::vector<std::vector<Vec2>>          paths;
+    std::vector<unsigned int>               path_epochs;    // epoka mapy, do ktorej sciezka zostala sprawdzona
+    std::vector<std::size_t>                path_tickets;   // numer oczekujacego zlecenia planera
+    std::vector<std::vector<Vec2>>          path_avoids;    // pola omijane przez najblizsze wyszukiwanie
+
+    // indeksowane numerem uchwytu
+    std::vector<unsigned int>   slot_of;
+    std::vector<unsigned int>   generations;
+    std::vector<unsigned int>   free_handles;
+
+    // kolejki zdarzen: koniec wymiany wiedzy (wg kroku) i smierc z glodu (wg dnia ostatniego posilku)
+    std::vector<TimedEvent>     cooldown_events;
+    std::vector<TimedEvent>     starvation_events;
+
+    // odlozone zmiany wiedzy (wiedza moze byc wspolna dla wielu agentow)
+    bool                                                deferring;
+    std::vector<std::pair<Knowledge *, Knowledge::Update>> deferred_updates;
+    std::vector<std::pair<Knowledge const *, Vec2>>      deferred_harmful;   // odlozone pola zablokowane i niebezpieczne
+};
\ No newline at end of file
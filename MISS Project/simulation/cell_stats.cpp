@@ -0,0 +1,120 @@
+#include "cell_stats.h"
+
+#include <algorithm>
+
+CellStats::CellStats()
+    : discovered_count(0)
+    , width(0)
+    , height(0)
+    , tracking(false)
+{
+    std::fill(std::begin(maxima), std::end(maxima), 0);
+}
+
+void CellStats::reset(Vec2 const &_dimensions)
+{
+    width = _dimensions.x;
+    height = _dimensions.y;
+
+    for (auto &&c : counters) {
+        c.assign(width * height, 0);
+    }
+    std::fill(std::begin(maxima), std::end(maxima), 0);
+    discovered_count = 0;
+
+    changed.assign(tracking ? width * height : 0, 0);
+    changed_list.clear();
+}
+
+void CellStats::add(Counter _counter, Vec2 const &_pos)
+{
+    if (_pos.x < 0 || _pos.x >= width || _pos.y < 0 || _pos.y >= height) {
+        return;
+    }
+
+    int idx = _pos.y * width + _pos.x;
+    unsigned int value = ++counters[_counter][idx];
+    maxima[_counter] = std::max(maxima[_counter], value);
+
+    if (_counter == Discoveries && value == 1) {
+        ++discovered_count;
+    }
+
+    if (tracking && !changed[idx]) {
+        changed[idx] = 1;
+        changed_list.push_back(_pos);
+    }
+}
+
+unsigned int CellStats::get(Counter _counter, Vec2 const &_pos) const
+{
+    if (_pos.x < 0 || _pos.x >= width || _pos.y < 0 || _pos.y >= height) {
+        return 0;
+    }
+    return counters[_counter][_pos.y * width + _pos.x];
+}
+
+std::vector<unsigned int> const & CellStats::values(Counter _counter) const
+{
+    return counters[_counter];
+}
+
+unsigned int CellStats::max_value(Counter _counter) const
+{
+    return maxima[_counter];
+}
+
+unsigned int CellStats::discovered() const
+{
+    return discovered_count;
+}
+
+void CellStats::accumulate(CellStats const &_other)
+{
+    if (_other.width != width || _other.height != height) {
+        return;
+    }
+
+    for (int c = 0; c < CountersNum; ++c) {
+        maxima[c] = 0;
+        for (std::size_t i = 0; i < counters[c].size(); ++i) {
+            counters[c][i] += _other.counters[c][i];
+            maxima[c] = std::max(maxima[c], counters[c][i]);
+        }
+    }
+
+    discovered_count = static_cast<unsigned int>(std::count_if(counters[Discoveries].begin(), counters[Discoveries].end(),
+                                                               [](unsigned int _v) { return _v > 0; }));
+}
+
+void CellStats::track_changes(bool _track)
+{
+    tracking = _track;
+    changed.assign(tracking ? width * height : 0, 0);
+    changed_list.clear();
+}
+
+void CellStats::take_changes(std::vector<Vec2> &_changes)
+{
+    for (auto &&p : changed_list) {
+        changed[p.y * width + p.x] = 0;
+    }
+    _changes.insert(_changes.end(), changed_list.begin(), changed_list.end());
+    changed_list.clear();
+}
+
+void CellStats::dump(std::ostream &_out, Counter _counter) const
+{
+    for (int i = 0; i < height; ++i) {
+        for (int j = 0; j < width; ++j) {
+            _out << counters[_counter][i * width + j] << (j + 1 < width ? " " : "");
+        }
+        _out << std::endl;
+    }
+}
+
+char const * CellStats::name(Counter _counter)
+{
+    static char const * names[CountersNum] = { "visits", "discoveries", "deaths", "shares" };
+    return names[_counter];
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <vector>
+#include <ostream>
+
+#include "utils.h"
+
+/**
+ * Klasa przechowujaca statystyki pol mapy w gestych tablicach (jedna wartosc na pole).
+ * Kazde zdarzenie to staly koszt, a liczba odkrytych pol jest liczona na biezaco.
+ */
+class CellStats
+{
+public:
+    /**
+     * Rodzaje liczonych zdarzen
+     */
+    enum Counter
+    {
+        Visits,         // kroki spedzone przez agentow na polu
+        Discoveries,    // decyzje agentow o wejsciu na pole
+        Deaths,         // smierci agentow na polu
+        Shares,         // wymiany wiedzy agentow stojacych na polu
+        CountersNum,
+    };
+
+    /**
+     * Konstruktor
+     */
+    CellStats();
+
+    /**
+     * Metoda zeruje statystyki dla mapy o podanych wymiarach
+     * @param dimensions wymiary mapy
+     */
+    void reset(Vec2 const &);
+
+    /**
+     * Metoda zwieksza licznik danego pola
+     * @param counter rodzaj zdarzenia
+     * @param pos pozycja pola
+     */
+    void add(Counter, Vec2 const &);
+
+    /**
+     * Metoda zwraca wartosc licznika danego pola
+     * @param counter rodzaj zdarzenia
+     * @param pos pozycja pola
+     * @return wartosc licznika
+     */
+    unsigned int get(Counter, Vec2 const &) const;
+
+    /**
+     * Metoda zwraca cala tablice licznika (wiersz po wierszu)
+     * @param counter rodzaj zdarzenia
+     * @return tablica wartosci
+     */
+    std::vector<unsigned int> const & values(Counter) const;
+
+    /**
+     * Metoda zwraca najwieksza wartosc licznika
+     * @param counter rodzaj zdarzenia
+     * @return najwieksza wartosc
+     */
+    unsigned int max_value(Counter) const;
+
+    /**
+     * Metoda zwraca ilosc odkrytych pol
+     * @return ilosc pol z niezerowym licznikiem odkryc
+     */
+    unsigned int discovered() const;
+
+    /**
+     * Metoda dodaje statystyki innej symulacji na tej samej mapie (np. sumowanie kolejnych testow)
+     * @param other statystyki
+     */
+    void accumulate(CellStats const &);
+
+    /**
+     * Metoda wlacza zapamietywanie pol zmienionych od ostatniego odczytu (dla watku rysujacego)
+     * @param track
+     */
+    void track_changes(bool);
+
+    /**
+     * Metoda przekazuje pola zmienione od ostatniego wywolania (kazde pole co najwyzej raz)
+     * @param out changes wektor do ktorego dopisywane sa pozycje
+     */
+    void take_changes(std::vector<Vec2> &);
+
+    /**
+     * Metoda zapisuje tablice licznika jako wiersze liczb oddzielonych spacjami
+     * @param out stream
+     * @param counter rodzaj zdarzenia
+     */
+    void dump(std::ostream &, Counter) const;
+
+    /**
+     * Metoda zwraca nazwe licznika
+     * @param counter rodzaj zdarzenia
+     * @return nazwa
+     */
+    static char const * name(Counter);
+
+private:
+    std::vector<unsigned int>   counters[CountersNum];
+    unsigned int                maxima[CountersNum];
+    unsigned int                discovered_count;
+
+    int width;
+    int height;
+
+    bool                        tracking;
+    std::vector<char>           changed;
+    std::vector<Vec2>           changed_list;
+};
\ No newline at end of file
@@ -1,58 +1,83 @@
 #include "environment.h"
 #include "agent.h"
+#include "agent_store.h"
 
 #include <iostream>
+#include <limits>
 
 Environment::Environment(Map &_map, SimulationOptions &_opts)
     : map(_map)
     , simulation_options(_opts)
 {
+    cell_stats.reset(map.dimensions());
+
+    if (simulation_options.planner_threads > 0) {
+        planner.reset(new PathPlanner(map, simulation_options.planner_threads));
+    }
+    if (simulation_options.share_threads > 0) {
+        share_pool.reset(new ThreadPool(simulation_options.share_threads));
+    }
 }
 
+Environment::~Environment() = default;
+
 
-void Environment::step(std::vector<Agent> &_agents)
+void Environment::step(AgentStore &_agents)
 {
-    for (auto it = share_timers.begin(); it != share_timers.end(); ) {
-        if (--it->second == 0) {
-            it = share_timers.erase(it);
-        } else {
-            ++it;
+    _agents.begin_step(simulation_options.step_counter);
+
+    if (planner) {
+        plan_and_act(_agents);
+    } else {
+        for (std::size_t i = 0; i < _agents.size(); ++i) {
+            Agent a = _agents[i];
+            if (a.share_timer() == 0) {
+                a.make_decision(map);
+                do_action(a);
+            }
         }
     }
 
-    for (auto &&a : _agents) {
-        if (share_timers.find(a.get_id()) == share_timers.end()) {
-            a.set_share(false);
-            a.make_decision(map);
-            do_action(a);
-        }
-        a.increase_food_timer();
-        a.next_day();
+    // glod i czas zycia liczone sa od numeru dnia - obslugiwani sa tylko agenci umierajacy z glodu
+    _agents.next_day();
+
+    for (std::size_t i = 0; i < _agents.size(); ++i) {
+        Agent a = _agents[i];
         if (!a.is_alive()) {
             lifetimers.push_back(a.lifetime());
+            if (a.starved()) {
+                cell_stats.add(CellStats::Deaths, a.get_position());
+            }
+        } else {
+            cell_stats.add(CellStats::Visits, a.get_position());
         }
     }
 
     
     if (!simulation_options.common_knowledge) {
-        for (int i = 0; i < _agents.size(); ++i) {
-            for (int j = 0; j < _agents.size(); ++j) {
-                unsigned int a1 = _agents[i].get_id();
-                unsigned int a2 = _agents[j].get_id();
-                if (i == j || !_agents[i].is_alive() || !_agents[j].is_alive() || share_timers.find(a1) != share_timers.end() || share_timers.find(a2) != share_timers.end() ||
-                    (recent_shares[{a1, a2}] == _agents[i].has_new_knowledge() && random_double() > simulation_options.repeated_share) || _agents[i].starving() || _agents[j].starving()) {
-                    continue;
-                }
-
-                if (euklid_dist(_agents[i].get_position(), _agents[j].get_position()) < simulation_options.share_radius) {
-                    _agents[i].share_knowledge(_agents[j], map);
-                    recent_shares[{a1, a2}] = _agents[i].has_new_knowledge();
-                    share_timers[a1] = simulation_options.learn_time;
-                    share_timers[a2] = simulation_options.learn_time;
-                    _agents[i].set_share(true);
-                    _agents[j].set_share(true);
-                }
-            }
+        share_graph.build(_agents, simulation_options.share_radius);
+
+        // ponowna wymiana z tym samym agentem (bez nowej wiedzy) tylko z pewnym prawdopodobienstwem
+        share_graph.filter([&](ShareGraph::Edge const &_e) {
+            return recent_share(_e.giver_id, _e.receiver_id) != _agents[_e.giver].has_new_knowledge() ||
+                   random_double() <= simulation_options.repeated_share;
+        });
+
+        auto const &pairs = share_graph.match();
+        if (!pairs.empty()) {
+            exchange_knowledge(_agents, pairs);
+        }
+
+        for (auto &&e : pairs) {
+            Agent ai = _agents[e.giver];
+            Agent aj = _agents[e.receiver];
+            recent_shares[{e.giver_id, e.receiver_id}] = ai.has_new_knowledge();
+            ai.set_share_timer(simulation_options.learn_time);
+            aj.set_share_timer(simulation_options.learn_time);
+            ai.set_share(true);
+            aj.set_share(true);
+            cell_stats.add(CellStats::Shares, ai.get_position());
+            cell_stats.add(CellStats::Shares, aj.get_position());
         }
     }
 
@@ -68,9 +93,14 @@ void Environment::step(std::vector<Agent> &_agents)
     }
 }
 
-std::unordered_set<Vec2> const & Environment::get_discovered() const
+CellStats const & Environment::get_stats() const
+{
+    return cell_stats;
+}
+
+CellStats & Environment::get_stats()
 {
-    return discovered;
+    return cell_stats;
 }
 
 std::vector<unsigned int> const & Environment::get_lifetimes() const
@@ -78,13 +108,91 @@ std::vector<unsigned int> const & Environment::get_lifetimes() const
     return lifetimers;
 }
 
+int Environment::recent_share(unsigned int _a1, unsigned int _a2) const
+{
+    // odczyt bez wstawiania - brak wpisu oznacza 0 (jak domyslna wartosc operatora [])
+    auto it = recent_shares.find({ _a1, _a2 });
+    return it != recent_shares.end() ? it->second : 0;
+}
+
 // -----
 
-int& get_with_def(std::unordered_map<Vec2, int> &m, Vec2 const &key, int val)
+void Environment::collect_paths(AgentStore &_agents)
+{
+    if (!planner) {
+        return;
+    }
+
+    auto &requests = planner->wait();
+    for (std::size_t i = 0; i < _agents.size(); ++i) {
+        Agent a = _agents[i];
+        if (a.awaits_path()) {
+            a.receive_path(requests);
+        }
+    }
+    planner->clear();
+
+    _agents.defer_knowledge_updates(false);
+    _agents.apply_knowledge_updates();
+}
+
+void Environment::plan_and_act(AgentStore &_agents)
 {
-    if (m.find(key) == m.end())
-        return (m[key] = val);
-    return m[key];
+    // wspolna wiedza jest czytana przez watki wyznaczajace sciezki - jej zmiany odkladane sa do odebrania sciezek
+    _agents.defer_knowledge_updates(simulation_options.common_knowledge);
+
+    planner->reserve(_agents.size());
+    for (std::size_t i = 0; i < _agents.size(); ++i) {
+        Agent a = _agents[i];
+        if (a.share_timer() == 0) {
+            // nowo narodzony agent nie zlecil jeszcze sciezki - pierwsza wyznaczana jest od razu (jak bez planera),
+            // inaczej czekajac stalby na polu populacji i pobieral z niego jedzenie
+            if (a.lifetime() == 0) {
+                a.make_decision(map);
+            } else {
+                a.follow_path();
+            }
+            do_action(a);
+
+            // agent bez sciezki stoi w miejscu do czasu odebrania wyniku
+            if (a.is_alive() && !a.is_path_valid(map)) {
+                a.update_target(map);
+                a.request_path(*planner);
+                planner->dispatch();
+            }
+        }
+    }
+}
+
+void Environment::exchange_knowledge(AgentStore &_agents, std::vector<ShareGraph::Edge> const &_pairs)
+{
+    // kazda para losuje z wlasnego strumienia, wiec wynik nie zalezy od ilosci watkow i kolejnosci wymian
+    const unsigned long long seed = (static_cast<unsigned long long>(random_int(0, std::numeric_limits<int>::max())) << 32) ^
+                                    static_cast<unsigned long long>(random_int(0, std::numeric_limits<int>::max()));
+
+    // wymiana zmienia wiedze agentow - wczesniej musza zakonczyc sie ich wyszukiwania sciezek
+    if (planner) {
+        for (auto &&e : _pairs) {
+            _agents[e.giver].wait_for_path(*planner);
+            _agents[e.receiver].wait_for_path(*planner);
+        }
+    }
+
+    auto exchange = [&](std::size_t _k) {
+        auto &&e = _pairs[_k];
+        RandomStream rng(seed ^ RandomStream((static_cast<unsigned long long>(e.giver_id) << 32) | e.receiver_id).next());
+        Agent ai = _agents[e.giver];
+        Agent aj = _agents[e.receiver];
+        ai.share_knowledge(aj, map, rng);
+    };
+
+    if (share_pool) {
+        share_pool->parallel_for(_pairs.size(), exchange);
+    } else {
+        for (std::size_t k = 0; k < _pairs.size(); ++k) {
+            exchange(k);
+        }
+    }
 }
 
 // -----
@@ -94,13 +202,10 @@ void Environment::do_action(Agent &_agent)
     auto dec = _agent.get_decision();
     auto field = map.get_field(dec);
 
-    discovered.insert(dec);
+    cell_stats.add(CellStats::Discoveries, dec);
 
     if (field == Field::Water || field == Field::Food) {
-        if (--get_with_def(places, dec, simulation_options.default_field_value) < 0) {
-            map.change_field(dec, Field::Empty);
-            places.erase(dec);
-        }
+        map.consume(dec, simulation_options.default_field_value);
     }
 
     if (field == Field::Blocked) {
@@ -113,12 +218,10 @@ void Environment::do_action(Agent &_agent)
         bool is_alive = random_double() < simulation_options.survival_chance;
         if (!is_alive) {
             _agent.die();
+            cell_stats.add(CellStats::Deaths, dec);
         } else {
             _agent.receive_reward(Reward{ dec, -1.0 });
-            if (--get_with_def(places, dec, simulation_options.default_field_value) < 0) {
-                map.change_field(dec, Field::Empty);
-                places.erase(dec);
-            }
+            map.consume(dec, simulation_options.default_field_value);
         }
     } else if (field == Field::Population) {
         if (_agent.carrying_food()) {
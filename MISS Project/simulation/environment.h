@@ -2,9 +2,16 @@
 
 #include "map.h"
 #include "simulation_options.h"
+#include "cell_stats.h"
+#include "path_planner.h"
+#include "share_graph.h"
+#include "thread_pool.h"
+
+#include <memory>
 
 
 class Agent;
+class AgentStore;
 
 /**
  * Struktura trzymajaca informacje o nagrodzie jaka otrzymal agent
@@ -28,17 +35,35 @@ public:
      */
     Environment(Map &, SimulationOptions &);
 
+    /**
+     * Destruktor
+     */
+    ~Environment();
+
     /**
      * Metoda wykonujaca krok symulacji na zbiorze agentow
-     * @param agents wektor agentow
+     * @param agents magazyn agentow
+     */
+    void step(AgentStore &);
+
+    /**
+     * Metoda odbiera sciezki wyznaczone w poprzednim kroku (na poczatku kroku, przed narodzinami).
+     * Przy wspolnej wiedzy dopiero wtedy wprowadzane sa jej odlozone zmiany.
+     * @param agents magazyn agentow
      */
-    void step(std::vector<Agent> &);
+    void collect_paths(AgentStore &);
     
     /**
-     * Metoda zwracajaca set odkrytych przez agentow obszarow
-     * @return set odkryte pozycje
+     * Metoda zwracajaca statystyki pol (odwiedziny, odkrycia, smierci, wymiany wiedzy)
+     * @return statystyki pol
+     */
+    CellStats const & get_stats() const;
+
+    /**
+     * Metoda zwracajaca statystyki pol (do wlaczenia sledzenia zmian)
+     * @return statystyki pol
      */
-    std::unordered_set<Vec2> const & get_discovered() const;
+    CellStats & get_stats();
 
     /**
      * Metoda zwracajaca wektor zawierajacy czasy zycia kazdego z agentow
@@ -47,21 +72,52 @@ public:
     std::vector<unsigned int> const & get_lifetimes() const;
 
 protected:
+    /**
+     * Metoda wykonujaca ruch agentow z asynchronicznym planowaniem sciezek.
+     * Agent bez sciezki zleca jej wyznaczenie po swoim ruchu, a wyniki odbierane sa dopiero przez collect_paths,
+     * wiec wyszukiwanie trwa rowniez w czasie wymian wiedzy, nowego dnia, zmian terenu i publikacji stanu.
+     * Pierwsza sciezka nowo narodzonego agenta wyznaczana jest od razu.
+     * Ruch i akcje agentow wykonywane sa sekwencyjnie (jeden watek) - w tle wyznaczane sa jedynie sciezki.
+     * Przy wspolnej wiedzy jej zmiany sa odkladane do odebrania sciezek, wiec w trakcie kroku odczyty wiedzy
+     * (rowniez agenta, ktory zmiane spowodowal) widza jej stan z poczatku kroku. Wyszukiwania omijaja jednak
+     * odlozone pola zablokowane i niebezpieczne, wiec agent nie wraca od razu na sciane, w ktora uderzyl.
+     * @param agents magazyn agentow
+     */
+    void plan_and_act(AgentStore &);
+
+    /**
+     * Metoda wykonuje wymiany wiedzy wybranych par (rozlaczne pary wymieniaja wiedze rownolegle).
+     * Wymiana czeka na zakonczenie wyszukiwania sciezek swoich agentow.
+     * @param agents magazyn agentow
+     * @param pairs pary agentow
+     */
+    void exchange_knowledge(AgentStore &, std::vector<ShareGraph::Edge> const &);
+
     /**
      * Metoda wykonujaca zaplanowana przez agenta akcje
      * @param agent
      */
     void do_action(Agent &);
 
+    /**
+     * Metoda zwraca stan wiedzy agenta z ostatniej wymiany z danym agentem (bez dodawania wpisu)
+     * @param a1 id agenta przekazujacego wiedze
+     * @param a2 id agenta otrzymujacego wiedze
+     * @return wskaznik zmiany wiedzy z ostatniej wymiany (0 gdy jej nie bylo)
+     */
+    int recent_share(unsigned int, unsigned int) const;
+
 private:
     std::unordered_map<std::pair<int, int>, int> recent_shares;
-    std::unordered_map<int, int> share_timers;
 
-    std::unordered_map<Vec2, int> places;
-    std::unordered_set<Vec2> discovered;
+    CellStats cell_stats;
+    ShareGraph share_graph;
 
     std::vector<unsigned int> lifetimers;
 
+    std::unique_ptr<PathPlanner> planner;
+    std::unique_ptr<ThreadPool>  share_pool;
+
     Map                 &map;
     SimulationOptions   &simulation_options;
 };
\ No newline at end of file
@@ -0,0 +1,381 @@
+#include "knowledge.h"
+#include "scratch.h"
+
+#include <algorithm>
+
+namespace
+{
+    /**
+     * Przyblizona pamiec tablicy haszujacej (wezly i kubelki)
+     * @param map tablica
+     * @return ilosc bajtow
+     */
+    template <typename Map>
+    std::size_t hash_bytes(Map const &_map)
+    {
+        return _map.size() * (sizeof(typename Map::value_type) + 2 * sizeof(void *)) + _map.bucket_count() * sizeof(void *);
+    }
+
+    // wpis indeksu bez aktualnej pozycji - wezel zostaje, wiec ponowne dodanie pola nie alokuje pamieci
+    const std::size_t no_entry = static_cast<std::size_t>(-1);
+}
+
+Knowledge::Usage& Knowledge::Usage::operator+=(Usage const &_other)
+{
+    tiles += _other.tiles;
+    shared_tiles += _other.shared_tiles;
+    outside_cells += _other.outside_cells;
+    changes += _other.changes;
+    peers += _other.peers;
+    evicted_tiles += _other.evicted_tiles;
+    bytes += _other.bytes;
+    return *this;
+}
+
+// -----
+
+Knowledge::Knowledge(Vec2 const &_dimensions)
+    : tiles(_dimensions)
+{
+}
+
+std::shared_ptr<Knowledge> Knowledge::inherit() const
+{
+    std::shared_ptr<Knowledge> child(new Knowledge(tiles));
+    child->outside = outside;
+
+    // dziennik dziecka opisuje tylko pola, ktorych nie obejmuja kafelki
+    for (auto &&c : outside) {
+        if (c.second.planes & ((1 << KnowledgeTiles::Positive) | (1 << KnowledgeTiles::Negative))) {
+            child->change_index.emplace(c.first, child->change_log.size());
+            child->change_log.push_back(Change{ c.first, ++child->change_seq, true });
+            ++child->outside_changes;
+        }
+    }
+    return child;
+}
+
+void Knowledge::set_budget(std::size_t _budget, bool _plain_first)
+{
+    budget = _budget;
+    evict_plain_first = _plain_first;
+}
+
+Knowledge::Usage Knowledge::usage() const
+{
+    Usage u;
+    u.tiles = tiles.tile_count();
+    u.shared_tiles = tiles.shared_count();
+    u.outside_cells = outside.size();
+    u.changes = change_log.size();
+    u.peers = offered.size();
+    u.evicted_tiles = evicted;
+    u.bytes = sizeof(Knowledge) + tiles.memory() + change_log.capacity() * sizeof(Change) +
+              hash_bytes(outside) + hash_bytes(change_index) + hash_bytes(offered) +
+              target_cells.capacity() * sizeof(Vec2) + hash_bytes(target_index);
+    return u;
+}
+
+bool Knowledge::has(Vec2 const &_pos, KnowledgeTiles::Plane _plane) const
+{
+    return (planes(_pos) >> _plane & 1) != 0;
+}
+
+unsigned int Knowledge::planes(Vec2 const &_pos) const
+{
+    if (tiles.contains(_pos)) {
+        return tiles.planes_of(_pos);
+    }
+    auto it = outside.find(_pos);
+    return it != outside.end() ? it->second.planes : 0;
+}
+
+void Knowledge::set(Vec2 const &_pos, KnowledgeTiles::Plane _plane, bool _value)
+{
+    if (tiles.contains(_pos)) {
+        tiles.set(_pos, _plane, _value);
+    } else if (_value) {
+        outside[_pos].planes |= 1 << _plane;
+    } else {
+        auto it = outside.find(_pos);
+        if (it != outside.end()) {
+            it->second.planes &= ~(1 << _plane);
+        }
+    }
+}
+
+int Knowledge::level(Vec2 const &_pos) const
+{
+    if (tiles.contains(_pos)) {
+        return tiles.level(_pos);
+    }
+    auto it = outside.find(_pos);
+    if (it != outside.end()) {
+        for (int p = 0; p < KnowledgeTiles::PlanesNum; ++p) {
+            if (it->second.planes & (1 << p)) {
+                return 4 - p;
+            }
+        }
+    }
+    return 0;
+}
+
+double Knowledge::value(Vec2 const &_pos) const
+{
+    if (tiles.contains(_pos)) {
+        return tiles.value(_pos);
+    }
+    auto it = outside.find(_pos);
+    return it != outside.end() ? it->second.value : 0.0;
+}
+
+void Knowledge::set_value(Vec2 const &_pos, double _value)
+{
+    if (tiles.contains(_pos)) {
+        tiles.set_value(_pos, _value);
+    } else {
+        outside[_pos].value = _value;
+    }
+    set(_pos, KnowledgeTiles::Known, true);
+}
+
+void Knowledge::touch(Vec2 const &_pos)
+{
+    if (!has(_pos, KnowledgeTiles::Known)) {
+        set_value(_pos, 0.0);
+    }
+}
+
+void Knowledge::forget(Vec2 const &_pos)
+{
+    const unsigned int forgotten = 1 << KnowledgeTiles::Known | 1 << KnowledgeTiles::Positive | 1 << KnowledgeTiles::Negative;
+    if (!(planes(_pos) & forgotten)) {
+        return;
+    }
+    if (tiles.contains(_pos)) {
+        tiles.set_value(_pos, 0.0);
+    } else {
+        outside[_pos].value = 0.0;
+    }
+    set(_pos, KnowledgeTiles::Known, false);
+    set(_pos, KnowledgeTiles::Positive, false);
+    set(_pos, KnowledgeTiles::Negative, false);
+}
+
+int Knowledge::time_stamp(Vec2 const &_pos) const
+{
+    if (tiles.contains(_pos)) {
+        return tiles.time_stamp(_pos);
+    }
+    auto it = outside.find(_pos);
+    return it != outside.end() ? it->second.time_stamp : 0;
+}
+
+void Knowledge::set_time_stamp(Vec2 const &_pos, int _time_stamp)
+{
+    if (tiles.contains(_pos)) {
+        tiles.set_time_stamp(_pos, _time_stamp);
+    } else {
+        outside[_pos].time_stamp = _time_stamp;
+    }
+}
+
+void Knowledge::notify(Vec2 const &_pos)
+{
+    if (auto changes = observer.lock()) {
+        changes->push_back(_pos);
+    }
+
+    const unsigned int known = planes(_pos);
+    bool is_positive = (known >> KnowledgeTiles::Positive & 1) != 0;
+    bool is_negative = (known >> KnowledgeTiles::Negative & 1) != 0;
+
+    const bool off_map = !tiles.contains(_pos);
+    auto it = change_index.find(_pos);
+    if (it != change_index.end() && it->second != no_entry) {
+        change_log[it->second].live = false;
+        ++dead_changes;
+        outside_changes -= off_map;
+    }
+
+    // w dzienniku trzymane sa tylko pola, ktorymi agent moze sie podzielic
+    if (is_positive || is_negative) {
+        if (it != change_index.end()) {
+            it->second = change_log.size();
+        } else {
+            change_index.emplace(_pos, change_log.size());
+        }
+        change_log.push_back(Change{ _pos, ++change_seq, true });
+        outside_changes += off_map;
+    } else if (it != change_index.end()) {
+        it->second = no_entry;
+    }
+
+    if (targets_valid) {
+        update_target(_pos, is_positive && value(_pos) > target_threshold);
+    }
+
+    // pole zapomniane (np. z usunietego kafelka) zwalnia wezly indeksow, zeby limit pamieci obejmowal tez je
+    if (!(known >> KnowledgeTiles::Known & 1)) {
+        change_index.erase(_pos);
+        target_index.erase(_pos);
+    }
+
+    if (dead_changes > 64 && dead_changes * 2 > change_log.size()) {
+        compact_changes();
+    }
+    if (budget && tiles.tile_count() > budget) {
+        enforce_budget(_pos);
+    }
+}
+
+void Knowledge::apply(Update const &_update)
+{
+    switch (_update.kind) {
+    case Update::Touch:
+        touch(_update.pos);
+        break;
+    case Update::AddPositive:
+        set(_update.pos, KnowledgeTiles::Positive, true);
+        break;
+    case Update::AddNegative:
+        set(_update.pos, KnowledgeTiles::Negative, true);
+        break;
+    case Update::ErasePositive:
+        set(_update.pos, KnowledgeTiles::Positive, false);
+        break;
+    case Update::EraseNegative:
+        set(_update.pos, KnowledgeTiles::Negative, false);
+        break;
+    case Update::Forget:
+        forget(_update.pos);
+        break;
+    case Update::Block:
+        set(_update.pos, KnowledgeTiles::Blocked, true);
+        break;
+    case Update::Observe:
+        set_value(_update.pos, clamp(-1.0, 1.0, value(_update.pos) + _update.reward));
+        set_time_stamp(_update.pos, _update.step);
+        break;
+    case Update::Notify:
+        notify(_update.pos);
+        break;
+    }
+}
+
+std::vector<Knowledge::Change> const & Knowledge::changes() const
+{
+    return change_log;
+}
+
+std::size_t Knowledge::changes_for(unsigned int _peer) const
+{
+    auto it = offered.find(_peer);
+    if (it == offered.end()) {
+        return 0;
+    }
+    unsigned int seq = it->second;
+    return std::upper_bound(change_log.begin(), change_log.end(), seq, [](unsigned int _seq, Change const &_c) {
+        return _seq < _c.seq;
+    }) - change_log.begin();
+}
+
+bool Knowledge::covered_by_tiles() const
+{
+    return outside_changes == 0;
+}
+
+void Knowledge::mark_offered(unsigned int _peer)
+{
+    offered[_peer] = change_seq;
+}
+
+std::vector<Vec2> const & Knowledge::targets(double _threshold)
+{
+    if (!targets_valid || _threshold != target_threshold) {
+        target_cells.clear();
+        target_index.clear();
+        target_threshold = _threshold;
+        targets_valid = true;
+        for_each(KnowledgeTiles::Positive, [&](Vec2 const &_p) {
+            if (value(_p) > _threshold) {
+                update_target(_p, true);
+            }
+        });
+    }
+    return target_cells;
+}
+
+// -----
+
+Knowledge::Knowledge(KnowledgeTiles const &_tiles)
+    : tiles(_tiles)
+{
+}
+
+void Knowledge::compact_changes()
+{
+    // numery wpisow sie nie zmieniaja, wiec zapamietane pozycje agentow pozostaja wazne
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < change_log.size(); ++i) {
+        if (change_log[i].live) {
+            change_log[kept] = change_log[i];
+            change_index[change_log[kept].pos] = kept;
+            ++kept;
+        }
+    }
+    change_log.resize(kept);
+    dead_changes = 0;
+
+    // agent, ktoremu przekazano wiedze przed pierwszym wpisem, nie rozni sie od nowego (pelna roznica kafelkow)
+    for (auto it = offered.begin(); it != offered.end(); ) {
+        if (change_log.empty() || change_log.front().seq > it->second) {
+            it = offered.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void Knowledge::enforce_budget(Vec2 const &_keep)
+{
+    ScratchVector<Vec2> cells_buffer;
+    auto &cells = *cells_buffer;
+
+    while (tiles.tile_count() > budget) {
+        std::size_t before = tiles.tile_count();
+        tiles.evict(_keep, evict_plain_first, cells);
+        if (tiles.tile_count() == before) {
+            break;
+        }
+        ++evicted;
+
+        // zapomniane pola znikaja z dziennika i podgladu (limit jest juz zachowany, wiec bez rekurencji)
+        for (auto &&c : cells) {
+            notify(c);
+        }
+    }
+}
+
+void Knowledge::update_target(Vec2 const &_pos, bool _target)
+{
+    auto it = target_index.find(_pos);
+    bool present = it != target_index.end() && it->second != no_entry;
+    if (_target && !present) {
+        if (it != target_index.end()) {
+            it->second = target_cells.size();
+        } else {
+            target_index.emplace(_pos, target_cells.size());
+        }
+        target_cells.push_back(_pos);
+    } else if (!_target && present) {
+        // na miejsce usuwanego pola trafia ostatnie
+        std::size_t at = it->second;
+        it->second = no_entry;
+        if (at + 1 != target_cells.size()) {
+            target_cells[at] = target_cells.back();
+            target_index[target_cells[at]] = at;
+        }
+        target_cells.pop_back();
+    }
+}
\ No newline at end of file
@@ -1,17 +1,287 @@
 #pragma once
 
 #include <unordered_map>
-#include <unordered_set>
+#include <memory>
+#include <vector>
 #include "utils.h"
+#include "knowledge_tiles.h"
 
 /**
- * Struktura odpowiedzialna za przechowywanie wiedzy agenta/ow
+ * Struktura odpowiedzialna za przechowywanie wiedzy agenta/ow.
+ * Wiedza o polach mapy trzymana jest w kafelkach (KnowledgeTiles), ktore nowy agent moze
+ * odziedziczyc bez kopiowania, a wiedza o polach poza mapa w osobnej tablicy.
+ * Ilosc kafelkow moze byc ograniczona - po przekroczeniu limitu agent zapomina wybrany kafelek.
+ * Zmiany dobrych i zlych miejsc zapisywane sa w dzienniku z numerami kolejnymi, a dla kazdego
+ * agenta z ktorym wymieniano wiedze pamietany jest numer ostatniej przekazanej zmiany,
+ * wiec wymiana wiedzy przeglada jedynie zmiany od ostatniego kontaktu.
+ * Zmiany wynikajace z nagrody opisywane sa rekordami Update, ktore mozna zastosowac od razu
+ * albo odlozyc (wspolna wiedza przy rownoleglym wyznaczaniu sciezek).
  */
 struct Knowledge
 {
-    std::unordered_map<Vec2, int>    time_stamp;
-    std::unordered_map<Vec2, double> values;
-    std::unordered_set<Vec2>         positive;
-    std::unordered_set<Vec2>         negative;
-    std::unordered_set<Vec2>         blocked;
+    /**
+     * Wpis dziennika zmian
+     */
+    struct Change
+    {
+        Vec2            pos;
+        unsigned int    seq;
+        bool            live;   // false - pole zmienilo sie pozniej (lub przestalo byc dobre/zle)
+    };
+
+    /**
+     * Pojedyncza zmiana wiedzy o polu
+     */
+    struct Update
+    {
+        enum Kind : unsigned char
+        {
+            Touch,          // pole staje sie znane (wartosc 0, jesli nie bylo wartosci)
+            AddPositive,
+            AddNegative,
+            ErasePositive,
+            EraseNegative,
+            Forget,         // usuniecie wartosci oraz oznaczenia dobre/zle
+            Block,
+            Observe,        // dodanie nagrody do wartosci pola i zapisanie kroku
+            Notify,
+        };
+
+        Kind    kind;
+        Vec2    pos;
+        double  reward;
+        int     step;
+    };
+
+    /**
+     * Wiedza o polu lezacym poza mapa (rozpraszane miejsca moga wyjsc poza mape)
+     */
+    struct Cell
+    {
+        double          value = 0.0;
+        int             time_stamp = 0;
+        unsigned char   planes = 0;     // bit p - plaszczyzna p
+    };
+
+    /**
+     * Zuzycie pamieci przez wiedze
+     */
+    struct Usage
+    {
+        std::size_t tiles = 0;          // kafelki (wlasne i wspoldzielone)
+        std::size_t shared_tiles = 0;
+        std::size_t outside_cells = 0;
+        std::size_t changes = 0;        // wpisy dziennika zmian
+        std::size_t peers = 0;          // agenci, ktorym przekazano wiedze
+        std::size_t evicted_tiles = 0;  // kafelki usuniete od poczatku
+        std::size_t bytes = 0;          // przyblizona pamiec
+
+        Usage& operator+=(Usage const &);
+    };
+
+    KnowledgeTiles                   tiles;
+    std::unordered_map<Vec2, Cell>   outside;
+
+    // odbiorca zmian (np. podglad agenta) - dopisywane sa do niego pozycje zmienionych pol
+    mutable std::weak_ptr<std::vector<Vec2>> observer;
+
+    /**
+     * Konstruktor
+     * @param dimensions wymiary mapy (pola poza mapa trzymane sa w tablicy outside)
+     */
+    explicit Knowledge(Vec2 const & = Vec2());
+
+    /**
+     * Metoda tworzy wiedze dla nowego agenta dziedziczacego wiedze danego agenta.
+     * Kafelki sa wspoldzielone do pierwszego zapisu, a dziennik zmian zawiera jedynie pola spoza mapy
+     * (pola na mapie przekazywane sa przy pierwszym kontakcie na podstawie kafelkow).
+     * @return nowa wiedza
+     */
+    std::shared_ptr<Knowledge> inherit() const;
+
+    /**
+     * Metoda ustawia limit pamieci wiedzy
+     * @param budget maksymalna ilosc kafelkow (0 - bez ograniczenia)
+     * @param plain_first najpierw zapominane sa kafelki bez dobrych i zlych pol (zamiast najdawniej zmienianych)
+     */
+    void set_budget(std::size_t, bool);
+
+    /**
+     * Metoda zwraca zuzycie pamieci przez wiedze
+     * @return zuzycie pamieci
+     */
+    Usage usage() const;
+
+    /**
+     * Metoda sprawdza rodzaj wiedzy o polu
+     * @param pos pozycja pola
+     * @param plane rodzaj wiedzy
+     * @return informacja czy pole jest danego rodzaju
+     */
+    bool has(Vec2 const &, KnowledgeTiles::Plane) const;
+
+    /**
+     * Metoda zwraca wszystkie rodzaje wiedzy o polu jednym odczytem
+     * @param pos pozycja pola
+     * @return maska bitow - bit p odpowiada plaszczyznie p
+     */
+    unsigned int planes(Vec2 const &) const;
+
+    /**
+     * Metoda ustawia rodzaj wiedzy o polu
+     * @param pos pozycja pola
+     * @param plane rodzaj wiedzy
+     * @param value informacja czy pole jest danego rodzaju
+     */
+    void set(Vec2 const &, KnowledgeTiles::Plane, bool);
+
+    /**
+     * Metoda zwraca informacje o tym jak agent widzi dane pole
+     * @param pos pozycja pola
+     * @return 4 - zablokowane, 3 - dobre, 2 - zle, 1 - znane, 0 - nieznane
+     */
+    int level(Vec2 const &) const;
+
+    /**
+     * Metoda zwraca wartosc pola (0 dla nieznanego pola)
+     * @param pos pozycja pola
+     * @return wartosc pola
+     */
+    double value(Vec2 const &) const;
+
+    /**
+     * Metoda ustawia wartosc pola (pole staje sie znane)
+     * @param pos pozycja pola
+     * @param value wartosc pola
+     */
+    void set_value(Vec2 const &, double);
+
+    /**
+     * Metoda oznacza pole jako znane (z wartoscia 0, jesli nie bylo znane)
+     * @param pos pozycja pola
+     */
+    void touch(Vec2 const &);
+
+    /**
+     * Metoda usuwa wartosc pola oraz oznaczenia dobre/zle (zablokowanie i znacznik czasowy zostaja)
+     * @param pos pozycja pola
+     */
+    void forget(Vec2 const &);
+
+    /**
+     * Metoda zwraca znacznik czasowy wiedzy o polu (0 dla pola bez znacznika)
+     * @param pos pozycja pola
+     * @return znacznik czasowy
+     */
+    int time_stamp(Vec2 const &) const;
+
+    /**
+     * Metoda ustawia znacznik czasowy wiedzy o polu
+     * @param pos pozycja pola
+     * @param time_stamp znacznik czasowy
+     */
+    void set_time_stamp(Vec2 const &, int);
+
+    /**
+     * Metoda wywoluje funkcje dla kazdego pola danego rodzaju (najpierw pola mapy, potem pola spoza mapy)
+     * @param plane rodzaj wiedzy
+     * @param f funkcja przyjmujaca pozycje pola
+     */
+    template <typename F>
+    void for_each(KnowledgeTiles::Plane _plane, F _f) const
+    {
+        tiles.for_each(_plane, _f);
+        for (auto &&c : outside) {
+            if (c.second.planes & (1 << _plane)) {
+                _f(c.first);
+            }
+        }
+    }
+
+    /**
+     * Metoda informuje odbiorce o zmianie wiedzy o danym polu i zapisuje zmiane w dzienniku.
+     * Po przekroczeniu limitu pamieci usuwany jest kafelek inny niz kafelek zmienionego pola.
+     * @param pos pozycja pola
+     */
+    void notify(Vec2 const &);
+
+    /**
+     * Metoda wprowadza zmiane do wiedzy
+     * @param update zmiana
+     */
+    void apply(Update const &);
+
+    /**
+     * Metoda zwraca dziennik zmian (wpisy uporzadkowane wg numeru)
+     * @return dziennik zmian
+     */
+    std::vector<Change> const & changes() const;
+
+    /**
+     * Metoda zwraca indeks pierwszego wpisu dziennika nowszego niz ostatnio przekazany danemu agentowi
+     * @param peer id agenta
+     * @return indeks wpisu w dzienniku
+     */
+    std::size_t changes_for(unsigned int) const;
+
+    /**
+     * Metoda sprawdza czy wszystkie dobre i zle miejsca leza na mapie (sa opisane przez kafelki)
+     * @return informacja czy kafelki opisuja cala wiedze do przekazania
+     */
+    bool covered_by_tiles() const;
+
+    /**
+     * Metoda zapamietuje, ze danemu agentowi przekazano wszystkie dotychczasowe zmiany
+     * @param peer id agenta
+     */
+    void mark_offered(unsigned int);
+
+    /**
+     * Metoda zwraca dobre pola o wartosci wiekszej niz prog (kandydaci na cel agenta).
+     * Zbior jest poprawiany przy kazdej zmianie wiedzy (notify), a przegladany w calosci
+     * tylko po zmianie progu lub dla wiedzy odziedziczonej.
+     * @param threshold prog wartosci
+     * @return pola (w dowolnej kolejnosci)
+     */
+    std::vector<Vec2> const & targets(double);
+
+protected:
+    /**
+     * Metoda usuwa z dziennika nieaktualne wpisy
+     */
+    void compact_changes();
+
+    /**
+     * Metoda usuwa kafelki do osiagniecia limitu pamieci
+     * @param keep pole, ktorego kafelek nie moze zostac usuniety
+     */
+    void enforce_budget(Vec2 const &);
+
+    /**
+     * Metoda dodaje pole do kandydatow na cel lub je usuwa
+     * @param pos pozycja pola
+     * @param target informacja czy pole ma byc kandydatem
+     */
+    void update_target(Vec2 const &, bool);
+
+private:
+    /**
+     * Konstruktor wiedzy wspoldzielacej kafelki z inna wiedza
+     * @param tiles kafelki
+     */
+    explicit Knowledge(KnowledgeTiles const &);
+
+    std::vector<Change>                             change_log;
+    std::unordered_map<Vec2, std::size_t>           change_index;   // pozycja -> aktualny wpis (no_entry - brak)
+    std::unordered_map<unsigned int, unsigned int>  offered;        // id agenta -> numer ostatniej zmiany
+    unsigned int                                    change_seq = 0;
+    std::size_t                                     dead_changes = 0;
+    std::size_t                                     outside_changes = 0; // aktualne wpisy spoza mapy
+    std::size_t                                     budget = 0;
+    bool                                            evict_plain_first = false;
+    std::size_t                                     evicted = 0;
+    std::vector<Vec2>                               target_cells;   // kandydaci na cel
+    std::unordered_map<Vec2, std::size_t>           target_index;   // pozycja -> indeks w target_cells (no_entry - brak)
+    double                                          target_threshold = 0.0;
+    bool                                            targets_valid = false;  // zbior zbudowany dla target_threshold
 };
\ No newline at end of file
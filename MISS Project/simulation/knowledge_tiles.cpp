@@ -0,0 +1,458 @@
+#include "knowledge_tiles.h"
+
+#include <algorithm>
+#include <iterator>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MISS_PLANES_SSE2
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    // operacje na slowach plaszczyzn - wybierany jest najszerszy zestaw instrukcji dostepny przy kompilacji
+    struct ScalarOps
+    {
+        typedef std::uint64_t type;
+        static const std::size_t width = 1;
+
+        static type load(std::uint64_t const *_p) { return *_p; }
+        static void store(std::uint64_t *_p, type _v) { *_p = _v; }
+        static type and_not(type _a, type _b) { return ~_a & _b; }
+        static type and_(type _a, type _b) { return _a & _b; }
+        static type or_(type _a, type _b) { return _a | _b; }
+        static type xor_(type _a, type _b) { return _a ^ _b; }
+    };
+
+#if defined(__AVX2__)
+    struct VectorOps
+    {
+        typedef __m256i type;
+        static const std::size_t width = 4;
+
+        static type load(std::uint64_t const *_p) { return _mm256_loadu_si256(reinterpret_cast<__m256i const *>(_p)); }
+        static void store(std::uint64_t *_p, type _v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(_p), _v); }
+        static type and_not(type _a, type _b) { return _mm256_andnot_si256(_a, _b); }
+        static type and_(type _a, type _b) { return _mm256_and_si256(_a, _b); }
+        static type or_(type _a, type _b) { return _mm256_or_si256(_a, _b); }
+        static type xor_(type _a, type _b) { return _mm256_xor_si256(_a, _b); }
+    };
+#elif defined(MISS_PLANES_SSE2)
+    struct VectorOps
+    {
+        typedef __m128i type;
+        static const std::size_t width = 2;
+
+        static type load(std::uint64_t const *_p) { return _mm_loadu_si128(reinterpret_cast<__m128i const *>(_p)); }
+        static void store(std::uint64_t *_p, type _v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(_p), _v); }
+        static type and_not(type _a, type _b) { return _mm_andnot_si128(_a, _b); }
+        static type and_(type _a, type _b) { return _mm_and_si128(_a, _b); }
+        static type or_(type _a, type _b) { return _mm_or_si128(_a, _b); }
+        static type xor_(type _a, type _b) { return _mm_xor_si128(_a, _b); }
+    };
+#else
+    typedef ScalarOps VectorOps;
+#endif
+
+    /**
+     * Maski pol, ktore dajacy zna jako dobre/zle, a otrzymujacy widzi inaczej.
+     * Poziom pola (know_of) to pierwsza ustawiona plaszczyzna, wiec poziomy sa rowne gdy rowne sa
+     * jednoelementowe maski poziomow obu agentow.
+     */
+    template <typename Ops>
+    void diff_kernel(std::uint64_t const *const *_giver, std::uint64_t const *const *_receiver, std::size_t _words,
+                     std::uint64_t *_positive, std::uint64_t *_negative)
+    {
+        typedef typename Ops::type V;
+
+        for (std::size_t w = 0; w < _words; w += Ops::width) {
+            V gb = Ops::load(_giver[KnowledgeTiles::Blocked] + w);
+            V gp = Ops::load(_giver[KnowledgeTiles::Positive] + w);
+            V gn = Ops::load(_giver[KnowledgeTiles::Negative] + w);
+            V gk = Ops::load(_giver[KnowledgeTiles::Known] + w);
+            V rb = Ops::load(_receiver[KnowledgeTiles::Blocked] + w);
+            V rp = Ops::load(_receiver[KnowledgeTiles::Positive] + w);
+            V rn = Ops::load(_receiver[KnowledgeTiles::Negative] + w);
+            V rk = Ops::load(_receiver[KnowledgeTiles::Known] + w);
+
+            V g_above = Ops::or_(gb, gp);
+            V r_above = Ops::or_(rb, rp);
+            V diff = Ops::or_(Ops::xor_(gb, rb), Ops::xor_(Ops::and_not(gb, gp), Ops::and_not(rb, rp)));
+            diff = Ops::or_(diff, Ops::xor_(Ops::and_not(g_above, gn), Ops::and_not(r_above, rn)));
+            g_above = Ops::or_(g_above, gn);
+            r_above = Ops::or_(r_above, rn);
+            diff = Ops::or_(diff, Ops::xor_(Ops::and_not(g_above, gk), Ops::and_not(r_above, rk)));
+
+            Ops::store(_positive + w, Ops::and_(gp, diff));
+            Ops::store(_negative + w, Ops::and_(gn, diff));
+        }
+    }
+}
+
+KnowledgeTiles::Tile::Tile()
+    : refs(1)
+    , planes()
+    , values()
+    , time_stamps()
+{
+}
+
+KnowledgeTiles::Tile::Tile(Tile const &_other)
+    : refs(1)
+{
+    std::copy(std::begin(_other.planes), std::end(_other.planes), planes);
+    std::copy(std::begin(_other.values), std::end(_other.values), values);
+    std::copy(std::begin(_other.time_stamps), std::end(_other.time_stamps), time_stamps);
+}
+
+KnowledgeTiles::Page::Page()
+    : written()
+{
+    std::fill(std::begin(tiles), std::end(tiles), &empty_tile());
+}
+
+// -----
+
+KnowledgeTiles::KnowledgeTiles(Vec2 const &_dimensions)
+    : width(_dimensions.x)
+    , height(_dimensions.y)
+    , tiles_x((_dimensions.x + tile_size - 1) / tile_size)
+    , pages_x((tiles_x + page_size - 1) / page_size)
+    , hand(0)
+{
+    int tiles_y = (_dimensions.y + tile_size - 1) / tile_size;
+    int pages_y = (tiles_y + page_size - 1) / page_size;
+    pages.assign(static_cast<std::size_t>(pages_x) * pages_y, &empty_page());
+}
+
+KnowledgeTiles::KnowledgeTiles(KnowledgeTiles const &_other)
+    : width(_other.width)
+    , height(_other.height)
+    , tiles_x(_other.tiles_x)
+    , pages_x(_other.pages_x)
+    , pages(_other.pages)
+    , tile_ids(_other.tile_ids)
+    , hand(_other.hand)
+{
+    // strony sa wlasne, a kafelki wspoldzielone
+    for (auto &&page : pages) {
+        if (page != &empty_page()) {
+            page = new Page(*page);
+        }
+    }
+    for (auto &&id : tile_ids) {
+        tile_at(id)->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+KnowledgeTiles::~KnowledgeTiles()
+{
+    for (auto &&id : tile_ids) {
+        release(tile_at(id));
+    }
+    for (auto &&page : pages) {
+        if (page != &empty_page()) {
+            delete page;
+        }
+    }
+}
+
+bool KnowledgeTiles::contains(Vec2 const &_pos) const
+{
+    return _pos.x >= 0 && _pos.x < width && _pos.y >= 0 && _pos.y < height;
+}
+
+bool KnowledgeTiles::test(Vec2 const &_pos, Plane _plane) const
+{
+    std::size_t cell;
+    Tile const *tile = find(_pos, cell);
+    return (tile->planes[_plane * tile_words + (cell >> 6)] >> (cell & 63) & 1) != 0;
+}
+
+unsigned int KnowledgeTiles::planes_of(Vec2 const &_pos) const
+{
+    std::size_t cell;
+    Tile const *tile = find(_pos, cell);
+    std::uint64_t const *word = tile->planes + (cell >> 6);
+    const unsigned int bit = cell & 63;
+
+    unsigned int mask = 0;
+    for (int p = 0; p < PlanesNum; ++p) {
+        mask |= static_cast<unsigned int>(word[p * tile_words] >> bit & 1) << p;
+    }
+    return mask;
+}
+
+void KnowledgeTiles::set(Vec2 const &_pos, Plane _plane, bool _value)
+{
+    std::size_t cell;
+    if (!_value && find(_pos, cell) == &empty_tile()) {
+        return;
+    }
+
+    Tile *tile = modify(_pos, cell);
+    std::uint64_t bit = std::uint64_t(1) << (cell & 63);
+    auto &word = tile->planes[_plane * tile_words + (cell >> 6)];
+    word = _value ? (word | bit) : (word & ~bit);
+}
+
+int KnowledgeTiles::level(Vec2 const &_pos) const
+{
+    // poziom wyznacza pierwsza ustawiona plaszczyzna
+    static const int levels[1 << PlanesNum] = { 0, 4, 3, 4, 2, 4, 3, 4, 1, 4, 3, 4, 2, 4, 3, 4 };
+    return levels[planes_of(_pos)];
+}
+
+double KnowledgeTiles::value(Vec2 const &_pos) const
+{
+    std::size_t cell;
+    return find(_pos, cell)->values[cell];
+}
+
+void KnowledgeTiles::set_value(Vec2 const &_pos, double _value)
+{
+    std::size_t cell;
+    modify(_pos, cell)->values[cell] = _value;
+}
+
+int KnowledgeTiles::time_stamp(Vec2 const &_pos) const
+{
+    std::size_t cell;
+    return find(_pos, cell)->time_stamps[cell];
+}
+
+void KnowledgeTiles::set_time_stamp(Vec2 const &_pos, int _time_stamp)
+{
+    std::size_t cell;
+    modify(_pos, cell)->time_stamps[cell] = _time_stamp;
+}
+
+std::size_t KnowledgeTiles::tile_count() const
+{
+    return tile_ids.size();
+}
+
+std::size_t KnowledgeTiles::shared_count() const
+{
+    std::size_t shared = 0;
+    for (auto &&id : tile_ids) {
+        shared += tile_at(id)->refs.load(std::memory_order_relaxed) > 1;
+    }
+    return shared;
+}
+
+std::size_t KnowledgeTiles::memory() const
+{
+    std::size_t bytes = pages.capacity() * sizeof(Page *) + tile_ids.capacity() * sizeof(std::size_t);
+    for (auto &&page : pages) {
+        bytes += page != &empty_page() ? sizeof(Page) : 0;
+    }
+    for (auto &&id : tile_ids) {
+        bytes += sizeof(Tile) / std::max(tile_at(id)->refs.load(std::memory_order_relaxed), 1);
+    }
+    return bytes;
+}
+
+void KnowledgeTiles::evict(Vec2 const &_keep, bool _plain_first, std::vector<Vec2> &_cells)
+{
+    _cells.clear();
+    if (tile_ids.empty() || (tile_ids.size() == 1 && contains(_keep) && tile_ids[0] == tile_of(_keep))) {
+        return;
+    }
+
+    const std::size_t keep = contains(_keep) ? tile_of(_keep) : ~std::size_t(0);
+
+    bool found = false;
+    if (_plain_first) {
+        for (std::size_t k = 0; k < tile_ids.size() && !found; ++k) {
+            std::size_t at = (hand + k) % tile_ids.size();
+            std::uint64_t const *planes = tile_at(tile_ids[at])->planes;
+            std::uint64_t marks = 0;
+            for (std::size_t w = 0; w < tile_words; ++w) {
+                marks |= planes[Positive * tile_words + w] | planes[Negative * tile_words + w];
+            }
+            if (tile_ids[at] != keep && !marks) {
+                hand = at;
+                found = true;
+            }
+        }
+    }
+    // najwyzej dwa obroty - w pierwszym kasowane sa bity zapisu
+    while (!found) {
+        std::size_t id = tile_ids[hand];
+        if (id != keep && !mark_written(id, false)) {
+            found = true;
+        } else {
+            hand = (hand + 1) % tile_ids.size();
+        }
+    }
+
+    const std::size_t id = tile_ids[hand];
+    Tile *&tile = slot(id);
+    for (std::size_t w = 0; w < tile_words; ++w) {
+        std::uint64_t m = 0;
+        for (int p = 0; p < PlanesNum; ++p) {
+            m |= tile->planes[p * tile_words + w];
+        }
+        for (; m; m &= m - 1) {
+            _cells.push_back(cell_position(id, w * 64 + lowest_bit(m)));
+        }
+    }
+
+    release(tile);
+    tile = &empty_tile();
+    tile_ids[hand] = tile_ids.back();
+    tile_ids.pop_back();
+    if (hand >= tile_ids.size()) {
+        hand = 0;
+    }
+}
+
+void KnowledgeTiles::share_candidates(KnowledgeTiles const &_giver, KnowledgeTiles const &_receiver,
+                                      std::vector<Vec2> &_positive, std::vector<Vec2> &_negative)
+{
+    std::uint64_t positive_mask[tile_words], negative_mask[tile_words];
+    std::uint64_t const *giver[PlanesNum], *receiver[PlanesNum];
+
+    auto extract = [&](std::uint64_t const *_mask, std::size_t _tile, std::vector<Vec2> &_out) {
+        for (std::size_t w = 0; w < tile_words; ++w) {
+            for (std::uint64_t m = _mask[w]; m; m &= m - 1) {
+                _out.push_back(_giver.cell_position(_tile, w * 64 + lowest_bit(m)));
+            }
+        }
+    };
+
+    for (auto &&id : _giver.tile_ids) {
+        Tile const *g = _giver.tile_at(id);
+        Tile const *r = _receiver.tile_at(id);
+        // kafelek wspoldzielony przez obu agentow nie zawiera roznic
+        if (r == g) {
+            continue;
+        }
+        for (int p = 0; p < PlanesNum; ++p) {
+            giver[p] = g->planes + p * tile_words;
+            receiver[p] = r->planes + p * tile_words;
+        }
+
+        diff_kernel<VectorOps>(giver, receiver, tile_words, positive_mask, negative_mask);
+        extract(positive_mask, id, _positive);
+        extract(negative_mask, id, _negative);
+    }
+}
+
+// -----
+
+KnowledgeTiles::Tile & KnowledgeTiles::empty_tile()
+{
+    static Tile empty;
+    return empty;
+}
+
+KnowledgeTiles::Page & KnowledgeTiles::empty_page()
+{
+    static Page empty;
+    return empty;
+}
+
+KnowledgeTiles::Tile const * KnowledgeTiles::find(Vec2 const &_pos, std::size_t &_cell) const
+{
+    const int tx = _pos.x >> tile_shift;
+    const int ty = _pos.y >> tile_shift;
+    _cell = static_cast<std::size_t>(((_pos.y & (tile_size - 1)) << tile_shift) | (_pos.x & (tile_size - 1)));
+
+    Page const *page = pages[(ty >> page_shift) * pages_x + (tx >> page_shift)];
+    return page->tiles[((ty & (page_size - 1)) << page_shift) | (tx & (page_size - 1))];
+}
+
+KnowledgeTiles::Tile * KnowledgeTiles::modify(Vec2 const &_pos, std::size_t &_cell)
+{
+    _cell = static_cast<std::size_t>(((_pos.y & (tile_size - 1)) << tile_shift) | (_pos.x & (tile_size - 1)));
+    const std::size_t id = tile_of(_pos);
+
+    Tile *&tile = slot(id);
+    mark_written(id, true);
+    if (tile == &empty_tile()) {
+        tile = new Tile();
+        tile_ids.push_back(id);
+    } else if (tile->refs.load(std::memory_order_acquire) != 1) {
+        // kafelek wspoldzielony z inna wiedza - zapis trafia do wlasnej kopii
+        Tile *copy = new Tile(*tile);
+        release(tile);
+        tile = copy;
+    }
+    return tile;
+}
+
+KnowledgeTiles::Tile * KnowledgeTiles::tile_at(std::size_t _id) const
+{
+    const std::size_t tx = _id % tiles_x;
+    const std::size_t ty = _id / tiles_x;
+    Page const *page = pages[(ty >> page_shift) * pages_x + (tx >> page_shift)];
+    return page->tiles[((ty & (page_size - 1)) << page_shift) | (tx & (page_size - 1))];
+}
+
+KnowledgeTiles::Tile *& KnowledgeTiles::slot(std::size_t _id)
+{
+    const std::size_t tx = _id % tiles_x;
+    const std::size_t ty = _id / tiles_x;
+    Page *&page = pages[(ty >> page_shift) * pages_x + (tx >> page_shift)];
+    if (page == &empty_page()) {
+        page = new Page();
+    }
+    return page->tiles[((ty & (page_size - 1)) << page_shift) | (tx & (page_size - 1))];
+}
+
+bool KnowledgeTiles::mark_written(std::size_t _id, bool _written)
+{
+    const std::size_t tx = _id % tiles_x;
+    const std::size_t ty = _id / tiles_x;
+    Page *page = pages[(ty >> page_shift) * pages_x + (tx >> page_shift)];
+    const std::size_t idx = ((ty & (page_size - 1)) << page_shift) | (tx & (page_size - 1));
+    const std::uint64_t bit = std::uint64_t(1) << (idx & 63);
+
+    bool was_written = (page->written[idx >> 6] & bit) != 0;
+    page->written[idx >> 6] = _written ? (page->written[idx >> 6] | bit) : (page->written[idx >> 6] & ~bit);
+    return was_written;
+}
+
+std::size_t KnowledgeTiles::tile_of(Vec2 const &_pos) const
+{
+    return static_cast<std::size_t>(_pos.y >> tile_shift) * tiles_x + (_pos.x >> tile_shift);
+}
+
+void KnowledgeTiles::release(Tile *_tile)
+{
+    if (_tile->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete _tile;
+    }
+}
+
+Vec2 KnowledgeTiles::cell_position(std::size_t _tile, std::size_t _cell) const
+{
+    return Vec2(static_cast<int>(_tile / tiles_x) * tile_size + static_cast<int>(_cell / tile_size),
+                static_cast<int>(_tile % tiles_x) * tile_size + static_cast<int>(_cell % tile_size));
+}
+
+int KnowledgeTiles::lowest_bit(std::uint64_t _v)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long idx;
+    _BitScanForward64(&idx, _v);
+    return static_cast<int>(idx);
+#elif defined(__GNUC__)
+    return __builtin_ctzll(_v);
+#else
+    int idx = 0;
+    while (!(_v & 1)) {
+        _v >>= 1;
+        ++idx;
+    }
+    return idx;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,292 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+#include "utils.h"
+
+/**
+ * Wiedza o polach mapy przechowywana w kafelkach 32x32 pol przydzielanych przy pierwszym zapisie,
+ * wiec pamiec zalezy od obszaru poznanego przez agenta, a nie od rozmiaru mapy.
+ * Kafelek zawiera bity rodzajow wiedzy (po jednym bicie na pole dla kazdej plaszczyzny), wartosci
+ * i znaczniki czasowe pol. Pozwala sprawdzic jak agent widzi pole bez przeszukiwania tablic haszujacych,
+ * a roznice wiedzy dwoch agentow liczyc slowami 64-bitowymi (AVX2/SSE2, gdy sa dostepne przy kompilacji).
+ * Kopia wspoldzieli kafelki z oryginalem - kafelek jest kopiowany dopiero przy zapisie (kopiowanie przy zapisie),
+ * wiec wiedza dziedziczona przez nowego agenta nie jest kopiowana przy jego tworzeniu.
+ * Ilosc kafelkow mozna ograniczac usuwajac kafelki wybrane algorytmem zegarowym (bit zapisu na kafelek).
+ * Katalog kafelkow jest dwupoziomowy (strony 16x16 kafelkow), a brakujace strony i kafelki wskazuja
+ * wspolne puste obiekty - odczyt nie sprawdza istnienia kafelka, a pusta wiedza na duzej mapie
+ * zajmuje tylko tablice stron.
+ */
+class KnowledgeTiles
+{
+public:
+    /**
+     * Rodzaje wiedzy (kolejnosc jak w priorytecie Agent::know_of - od najwazniejszej)
+     */
+    enum Plane
+    {
+        Blocked,
+        Positive,
+        Negative,
+        Known,
+        PlanesNum,
+    };
+
+    /**
+     * Konstruktor
+     * @param dimensions wymiary mapy
+     */
+    explicit KnowledgeTiles(Vec2 const & = Vec2());
+
+    /**
+     * Konstruktor kopiujacy - kafelki sa wspoldzielone do pierwszego zapisu
+     * @param other kopiowana wiedza
+     */
+    KnowledgeTiles(KnowledgeTiles const &);
+
+    KnowledgeTiles& operator=(KnowledgeTiles const &) = delete;
+
+    ~KnowledgeTiles();
+
+    /**
+     * Metoda sprawdza czy pole lezy na mapie
+     * @param pos pozycja pola
+     * @return informacja czy pole jest opisane przez kafelki
+     */
+    bool contains(Vec2 const &) const;
+
+    /**
+     * Metoda sprawdza bit pola (tylko dla pol na mapie)
+     * @param pos pozycja pola
+     * @param plane rodzaj wiedzy
+     * @return wartosc bitu
+     */
+    bool test(Vec2 const &, Plane) const;
+
+    /**
+     * Metoda zwraca wszystkie bity pola jednym odczytem kafelka (tylko dla pol na mapie)
+     * @param pos pozycja pola
+     * @return maska bitow - bit p odpowiada plaszczyznie p
+     */
+    unsigned int planes_of(Vec2 const &) const;
+
+    /**
+     * Metoda ustawia bit pola (tylko dla pol na mapie)
+     * @param pos pozycja pola
+     * @param plane rodzaj wiedzy
+     * @param value wartosc bitu
+     */
+    void set(Vec2 const &, Plane, bool);
+
+    /**
+     * Metoda zwraca informacje o tym jak agent widzi dane pole (jak Agent::know_of)
+     * @param pos pozycja pola na mapie
+     * @return 4 - zablokowane, 3 - dobre, 2 - zle, 1 - znane, 0 - nieznane
+     */
+    int level(Vec2 const &) const;
+
+    /**
+     * Metoda zwraca wartosc pola (0 dla pola bez wartosci)
+     * @param pos pozycja pola na mapie
+     * @return wartosc pola
+     */
+    double value(Vec2 const &) const;
+
+    /**
+     * Metoda ustawia wartosc pola
+     * @param pos pozycja pola na mapie
+     * @param value wartosc pola
+     */
+    void set_value(Vec2 const &, double);
+
+    /**
+     * Metoda zwraca znacznik czasowy pola (0 dla pola bez znacznika)
+     * @param pos pozycja pola na mapie
+     * @return znacznik czasowy
+     */
+    int time_stamp(Vec2 const &) const;
+
+    /**
+     * Metoda ustawia znacznik czasowy pola
+     * @param pos pozycja pola na mapie
+     * @param time_stamp znacznik czasowy
+     */
+    void set_time_stamp(Vec2 const &, int);
+
+    /**
+     * Metoda wywoluje funkcje dla kazdego pola z ustawionym bitem (w kolejnosci kafelkow w tile_ids)
+     * @param plane rodzaj wiedzy
+     * @param f funkcja przyjmujaca pozycje pola
+     */
+    template <typename F>
+    void for_each(Plane _plane, F _f) const
+    {
+        for (auto &&id : tile_ids) {
+            std::uint64_t const *words = tile_at(id)->planes + _plane * tile_words;
+            for (std::size_t w = 0; w < tile_words; ++w) {
+                for (std::uint64_t m = words[w]; m; m &= m - 1) {
+                    _f(cell_position(id, w * 64 + lowest_bit(m)));
+                }
+            }
+        }
+    }
+
+    /**
+     * Metoda zwraca ilosc kafelkow (wlasnych i wspoldzielonych)
+     * @return ilosc kafelkow
+     */
+    std::size_t tile_count() const;
+
+    /**
+     * Metoda zwraca ilosc kafelkow wspoldzielonych z inna wiedza
+     * @return ilosc kafelkow
+     */
+    std::size_t shared_count() const;
+
+    /**
+     * Metoda zwraca przyblizona pamiec zajmowana przez kafelki (wspoldzielony kafelek liczony jest
+     * w czesci przypadajacej na jednego wlasciciela, wiec suma po agentach odpowiada calej pamieci)
+     * @return ilosc bajtow
+     */
+    std::size_t memory() const;
+
+    /**
+     * Metoda usuwa jeden kafelek wybrany algorytmem zegarowym - kafelek zmieniony od ostatniego
+     * przejscia wskazowki dostaje druga szanse (usuwane sa najdawniej zmieniane kafelki)
+     * @param keep pole, ktorego kafelek nie moze zostac usuniety
+     * @param plain_first najpierw usuwane sa kafelki bez dobrych i zlych pol (najmniejsze wartosci)
+     * @param cells wynik - pola usunietego kafelka, o ktorych byla jakakolwiek wiedza
+     */
+    void evict(Vec2 const &, bool, std::vector<Vec2> &);
+
+    /**
+     * Metoda wyznacza dobre i zle pola dajacego, ktore otrzymujacy widzi inaczej (przegladane sa tylko kafelki dajacego)
+     * @param giver wiedza dajacego
+     * @param receiver wiedza otrzymujacego (o tych samych wymiarach)
+     * @param positive wynik - dobre pola
+     * @param negative wynik - zle pola
+     */
+    static void share_candidates(KnowledgeTiles const &, KnowledgeTiles const &, std::vector<Vec2> &, std::vector<Vec2> &);
+
+private:
+    static const int            tile_shift = 5;
+    static const int            tile_size = 1 << tile_shift;
+    static const std::size_t    tile_cells = tile_size * tile_size;
+    static const std::size_t    tile_words = tile_cells / 64;   // slowa jednej plaszczyzny kafelka
+    static const int            page_shift = 4;
+    static const int            page_size = 1 << page_shift;    // strona katalogu to page_size x page_size kafelkow
+    static const std::size_t    page_tiles = page_size * page_size;
+
+    /**
+     * Kafelek wiedzy - licznik odwolan pozwala sprawdzic czy kafelek mozna zmienic w miejscu
+     */
+    struct Tile
+    {
+        std::atomic<int>    refs;
+        std::uint64_t       planes[PlanesNum * tile_words];
+        double              values[tile_cells];
+        int                 time_stamps[tile_cells];
+
+        Tile();
+        Tile(Tile const &);
+    };
+
+    /**
+     * Strona katalogu - kafelki fragmentu mapy i ich bity zapisu (algorytm zegarowy)
+     */
+    struct Page
+    {
+        Tile *              tiles[page_tiles];
+        std::uint64_t       written[page_tiles / 64];
+
+        Page();
+    };
+
+    /**
+     * Metoda zwraca wspolny pusty kafelek (brak kafelka - nigdy nie jest zmieniany ani zwalniany)
+     * @return pusty kafelek
+     */
+    static Tile & empty_tile();
+
+    /**
+     * Metoda zwraca wspolna pusta strone (brak strony - wskazuje tylko puste kafelki)
+     * @return pusta strona
+     */
+    static Page & empty_page();
+
+    /**
+     * Metoda zwraca kafelek pola (pusty kafelek, gdy kafelek nie istnieje)
+     * @param pos pozycja pola na mapie
+     * @param cell wynik - indeks pola w kafelku
+     * @return kafelek
+     */
+    Tile const * find(Vec2 const &, std::size_t &) const;
+
+    /**
+     * Metoda zwraca kafelek pola do zapisu - tworzy go lub kopiuje, gdy jest wspoldzielony
+     * @param pos pozycja pola na mapie
+     * @param cell wynik - indeks pola w kafelku
+     * @return kafelek
+     */
+    Tile * modify(Vec2 const &, std::size_t &);
+
+    /**
+     * Metoda zwraca kafelek o danym numerze
+     * @param id numer kafelka
+     * @return kafelek (pusty kafelek, gdy kafelek nie istnieje)
+     */
+    Tile * tile_at(std::size_t) const;
+
+    /**
+     * Metoda zwraca miejsce kafelka w katalogu - tworzy strone, gdy jej brakuje
+     * @param id numer kafelka
+     * @return wskaznik kafelka w stronie
+     */
+    Tile *& slot(std::size_t);
+
+    /**
+     * Metoda ustawia bit zapisu kafelka (strona kafelka musi istniec)
+     * @param id numer kafelka
+     * @param written nowa wartosc bitu
+     * @return poprzednia wartosc bitu
+     */
+    bool mark_written(std::size_t, bool);
+
+    /**
+     * Metoda zwraca numer kafelka zawierajacego pole
+     * @param pos pozycja pola na mapie
+     * @return numer kafelka
+     */
+    std::size_t tile_of(Vec2 const &) const;
+
+    /**
+     * Metoda zwalnia odwolanie do kafelka
+     * @param tile kafelek
+     */
+    static void release(Tile *);
+
+    /**
+     * Metoda zwraca pozycje pola kafelka
+     * @param tile numer kafelka
+     * @param cell indeks pola w kafelku
+     * @return pozycja pola
+     */
+    Vec2 cell_position(std::size_t, std::size_t) const;
+
+    /**
+     * Metoda zwraca numer najmlodszego ustawionego bitu
+     * @param v slowo (niezerowe)
+     * @return numer bitu
+     */
+    static int lowest_bit(std::uint64_t);
+
+    int                         width;
+    int                         height;
+    int                         tiles_x;
+    int                         pages_x;
+    std::vector<Page *>         pages;      // strony katalogu (pusta strona - brak kafelkow)
+    std::vector<std::size_t>    tile_ids;   // numery przydzielonych kafelkow (usuniecie przenosi ostatni)
+    std::size_t                 hand;       // wskazowka zegara - pozycja w tile_ids
+};
\ No newline at end of file
@@ -1,16 +1,24 @@
 #include "map.h"
 #include "agent.h"
+#include "mapped_file.h"
 
 #include <fstream>
+#include <cstring>
+#include <iterator>
 #include <iostream>
 #include <functional>
-#include <set>
+#include <algorithm>
+#include <limits>
 
 
+const int Map::no_capacity;
+
 Map::Map()
-    : agent_view(nullptr)
-    , width(0)
+    : width(0)
     , height(0)
+    , current_epoch(0)
+    , journal_begin(0)
+    , journal(journal_size)
 {
 }
 
@@ -18,143 +26,401 @@ Map::~Map() = default;
 
 // -----
 
-void Map::load(std::string const &_file)
+bool Map::load(std::string const &_file)
 {
-    std::ifstream file(_file);
+    MappedFile file(_file);
 
-    if (!file) {
+    if (!file.is_open()) {
         std::cout << "ERROR: file not found!" << std::endl;
-        return;
+        return false;
+    }
+
+    if (file.size() >= sizeof(BinaryMapHeader) && std::memcmp(file.data(), "MSMP", 4) == 0) {
+        return load_binary(file.data(), file.size());
+    }
+    return load_text(file.data(), file.size());
+}
+
+bool Map::save(std::string const &_file) const
+{
+    bool binary = _file.size() >= 4 && _file.compare(_file.size() - 4, 4, ".mpb") == 0;
+
+    std::ofstream file(_file, binary ? std::ios::binary : std::ios::out);
+    if (!file) {
+        std::cout << "ERROR: could not open " << _file << " for writing!" << std::endl;
+        return false;
     }
 
-    std::string line;
-    while (std::getline(file, line)) {
-        fields.push_back(std::vector<Field>());
-        for (auto &&c : line) {
-            if (c == '.') {
-                fields.back().push_back(Field::Empty);
-            } else if (c == 'F') {
-                fields.back().push_back(Field::Food);
-            } else if (c == 'X') {
-                fields.back().push_back(Field::Blocked);
-            } else if (c == 'W') {
-                fields.back().push_back(Field::Water);
-            } else if (c == 'P') {
-                fields.back().push_back(Field::Population);
-                population = Vec2(fields.size() - 1, fields.back().size() - 1);
-            } else if (c == 'T') {
-                fields.back().push_back(Field::Danger);
+    if (binary) {
+        BinaryMapHeader header;
+        std::memcpy(header.magic, "MSMP", 4);
+        header.version = 1;
+        header.width = width;
+        header.height = height;
+        header.start_y = population.y;
+        header.start_x = population.x;
+        file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+
+        std::vector<unsigned char> packed((fields.size() + 1) / 2, 0);
+        for (std::size_t i = 0; i < fields.size(); ++i) {
+            packed[i / 2] |= static_cast<unsigned char>(fields[i]) << ((i % 2) * 4);
+        }
+        file.write(reinterpret_cast<char const *>(packed.data()), packed.size());
+    } else {
+        static const char symbols[] = { '.', 'F', 'W', 'T', 'X', 'P' };
+        std::string line(width, '.');
+        for (int i = 0; i < height; ++i) {
+            for (int j = 0; j < width; ++j) {
+                line[j] = symbols[static_cast<int>(fields[index(i, j)])];
             }
+            file << line << '\n';
         }
     }
-    
-    width = fields.front().size();
-    height = fields.size();
+
+    return static_cast<bool>(file);
 }
 
-std::vector<Vec2> Map::search_path(Vec2 const &_start, 
-                                   Vec2 const &_end, 
-                                   std::shared_ptr<Knowledge> _knowledge,
-                                   int &_total_cost) const
+void Map::create(Vec2 const &_dimensions, std::vector<Field> _fields, Vec2 const &_start)
+{
+    fields = std::move(_fields);
+    width = _dimensions.x;
+    height = _dimensions.y;
+    population = _start;
+    reset_fields();
+}
+
+bool Map::load_text(char const *_data, std::size_t _size)
+{
+    // tablica przejsc znak -> pole, -1 oznacza znak niedozwolony, -2 znak pomijany
+    int lookup[256];
+    std::fill(std::begin(lookup), std::end(lookup), -1);
+    lookup['.'] = static_cast<int>(Field::Empty);
+    lookup['F'] = static_cast<int>(Field::Food);
+    lookup['X'] = static_cast<int>(Field::Blocked);
+    lookup['W'] = static_cast<int>(Field::Water);
+    lookup['P'] = static_cast<int>(Field::Population);
+    lookup['T'] = static_cast<int>(Field::Danger);
+    lookup[' '] = lookup['\t'] = lookup['\r'] = -2;
+
+    // szerokosc pierwszego wiersza pozwala zarezerwowac pamiec na cala mape
+    std::size_t first_line = 0;
+    while (first_line < _size && _data[first_line] != '\n') ++first_line;
+
+    std::vector<Field> loaded;
+    loaded.reserve(_size - _size / (first_line + 1));
+
+    int row_width = -1, rows = 0, column = 0, starts = 0, blank_line = 0;
+    Vec2 start;
+
+    for (std::size_t i = 0; i <= _size; ++i) {
+        if (i == _size || _data[i] == '\n') {
+            if (column > 0) {
+                if (row_width == -1) {
+                    row_width = column;
+                } else if (column != row_width) {
+                    std::cout << "ERROR: line " << rows + 1 << " has " << column << " fields, expected " << row_width << "!" << std::endl;
+                    return false;
+                }
+                ++rows;
+            } else if (blank_line == 0) {
+                blank_line = rows + 1;
+            }
+            column = 0;
+            continue;
+        }
+
+        int field = lookup[static_cast<unsigned char>(_data[i])];
+        if (field == -2) {
+            continue;
+        }
+        if (blank_line != 0) {
+            // puste wiersze dozwolone sa tylko na koncu pliku
+            std::cout << "ERROR: empty line " << blank_line << " inside the map!" << std::endl;
+            return false;
+        }
+        if (field == -1) {
+            std::cout << "ERROR: unknown character '" << _data[i] << "' at line " << rows + 1 << ", column " << column + 1 << "!" << std::endl;
+            return false;
+        }
+        if (field == static_cast<int>(Field::Population)) {
+            start = Vec2(rows, column);
+            ++starts;
+        }
+        loaded.push_back(static_cast<Field>(field));
+        ++column;
+    }
+
+    if (rows == 0) {
+        std::cout << "ERROR: map is empty!" << std::endl;
+        return false;
+    }
+    if (starts == 0) {
+        std::cout << "ERROR: map has no population start (P)!" << std::endl;
+        return false;
+    }
+    if (starts > 1) {
+        std::cout << "WARNING: map has " << starts << " population starts, using the last one." << std::endl;
+    }
+
+    fields = std::move(loaded);
+    width = row_width;
+    height = rows;
+    population = start;
+    reset_fields();
+    return true;
+}
+
+bool Map::load_binary(char const *_data, std::size_t _size)
+{
+    BinaryMapHeader header;
+    std::memcpy(&header, _data, sizeof(header));
+
+    if (header.version != 1) {
+        std::cout << "ERROR: unsupported binary map version " << header.version << "!" << std::endl;
+        return false;
+    }
+
+    // indeksy pol sa typu int - iloczyn wymiarow liczony jest w 64 bitach przed sprawdzeniem zakresu
+    const unsigned long long cells = static_cast<unsigned long long>(header.width) * header.height;
+    if (cells == 0) {
+        std::cout << "ERROR: map is empty!" << std::endl;
+        return false;
+    }
+    if (cells > static_cast<unsigned long long>(std::numeric_limits<int>::max())) {
+        std::cout << "ERROR: map " << header.height << "x" << header.width << " is too large!" << std::endl;
+        return false;
+    }
+
+    std::size_t count = static_cast<std::size_t>(cells);
+    if (_size - sizeof(header) < (count + 1) / 2) {
+        std::cout << "ERROR: binary map is truncated!" << std::endl;
+        return false;
+    }
+    if (header.start_y < 0 || header.start_y >= static_cast<int>(header.height) ||
+        header.start_x < 0 || header.start_x >= static_cast<int>(header.width)) {
+        std::cout << "ERROR: population start outside of the map!" << std::endl;
+        return false;
+    }
+
+    auto packed = reinterpret_cast<unsigned char const *>(_data + sizeof(header));
+    std::vector<Field> loaded(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        unsigned char field = (packed[i / 2] >> ((i % 2) * 4)) & 0x0F;
+        if (field > static_cast<unsigned char>(Field::Population)) {
+            std::cout << "ERROR: invalid field " << static_cast<int>(field) << " at cell " << i << "!" << std::endl;
+            return false;
+        }
+        loaded[i] = static_cast<Field>(field);
+    }
+
+    // jak przy mapie tekstowej - poczatkiem populacji musi byc pole P
+    if (loaded[static_cast<std::size_t>(header.start_y) * header.width + header.start_x] != Field::Population) {
+        std::cout << "ERROR: map has no population start (P) at " << header.start_y << "," << header.start_x << "!" << std::endl;
+        return false;
+    }
+
+    fields = std::move(loaded);
+    width = header.width;
+    height = header.height;
+    population = Vec2(header.start_y, header.start_x);
+    reset_fields();
+    return true;
+}
+
+namespace
 {
     struct heap_data
     {
-        heap_data() { }
-        heap_data(int _a, Vec2 const &_b, int _c)
-            : cost(_a), pos(_b), wave(_c) { }
+        int cost;
+        Vec2 pos;
+        int wave;
+        unsigned int order;
 
+        // odwrocony porzadek - na szczycie kopca jest najmniejszy koszt, potem najmniejsza fala,
+        // a przy remisie wczesniej dodany element
         bool operator<(heap_data const &_other) const
         {
-            return this->cost == _other.cost ? (this->wave == _other.wave ? this < &_other : this->wave < _other.wave) : this->cost < _other.cost;
+            if (cost != _other.cost) return cost > _other.cost;
+            if (wave != _other.wave) return wave > _other.wave;
+            return order > _other.order;
         }
+    };
 
-        int cost = std::numeric_limits<int>::max();
-        Vec2 pos;
-        int wave = std::numeric_limits<int>::max();
+    /**
+     * Tablice robocze wyszukiwania sciezki. Pole jest odwiedzone w biezacym wyszukiwaniu
+     * tylko gdy jego znacznik jest rowny numerowi wyszukiwania, wiec tablic nie trzeba czyscic.
+     */
+    struct SearchScratch
+    {
+        std::vector<unsigned int>   stamp;
+        std::vector<int>            cost;
+        std::vector<Vec2>           parent;
+        std::vector<heap_data>      heap;
+        unsigned int                current = 0;
+
+        void prepare(std::size_t _cells)
+        {
+            if (stamp.size() != _cells) {
+                stamp.assign(_cells, 0);
+                cost.resize(_cells);
+                parent.resize(_cells);
+                current = 0;
+            }
+            if (++current == 0) {
+                std::fill(stamp.begin(), stamp.end(), 0);
+                current = 1;
+            }
+            heap.clear();
+        }
+    };
+
+    thread_local SearchScratch search_scratch;
+}
+
+void Map::search_path(Vec2 const &_start, 
+                      Vec2 const &_end, 
+                      Knowledge const &_knowledge,
+                      int &_total_cost,
+                      std::vector<Vec2> &_path,
+                      std::vector<Vec2> const *_avoid) const
+{
+    auto &scratch = search_scratch;
+    scratch.prepare(fields.size());
+
+    // pola omijane oznaczane sa jako odwiedzone z najmniejszym kosztem, wiec nigdy nie trafiaja do kolejki
+    if (_avoid) {
+        for (auto &&p : *_avoid) {
+            int idx = index(p.y, p.x);
+            scratch.stamp[idx] = scratch.current;
+            scratch.cost[idx] = std::numeric_limits<int>::min();
+        }
+    }
+
+    auto has_cost = [&](Vec2 const &_p) {
+        return _p.x >= 0 && _p.x < width && _p.y >= 0 && _p.y < height && scratch.stamp[index(_p.y, _p.x)] == scratch.current;
+    };
+    auto known = [&](Vec2 const &_p) {
+        return _knowledge.has(_p, KnowledgeTiles::Known);
     };
 
-    std::set<heap_data> heap;
-    heap.insert(heap_data{ 0, _start, 0 });
+    unsigned int order = 0;
+    auto push = [&](heap_data const &_data) {
+        scratch.heap.push_back(_data);
+        std::push_heap(scratch.heap.begin(), scratch.heap.end());
+    };
 
-    std::unordered_set<Vec2> visited;
-    std::unordered_map<Vec2, int> costs;
-    std::unordered_map<Vec2, Vec2> parent;
+    push(heap_data{ 0, _start, 0, order++ });
 
-    parent[_start] = _start;
-    costs[_start] = 0;
+    int start_idx = index(_start.y, _start.x);
+    scratch.stamp[start_idx] = scratch.current;
+    scratch.cost[start_idx] = 0;
+    scratch.parent[start_idx] = _start;
 
-    heap_data pri_goal, sec_goal, tri_goal{ std::numeric_limits<int>::max(), _start, 0 };
+    const heap_data none{ std::numeric_limits<int>::max(), Vec2(), std::numeric_limits<int>::max(), 0 };
+    heap_data pri_goal = none, sec_goal = none, tri_goal{ std::numeric_limits<int>::max(), _start, 0, 0 };
 
-    while (!heap.empty()) {
-        auto top = *heap.begin();
-        heap.erase(heap.begin());
+    Vec2 around[6], near[6];
+
+    while (!scratch.heap.empty()) {
+        std::pop_heap(scratch.heap.begin(), scratch.heap.end());
+        auto top = scratch.heap.back();
+        scratch.heap.pop_back();
 
         if (top.pos == _end) {
             pri_goal = top;
             break;
         }
-        if (_knowledge->values.find(top.pos) == _knowledge->values.end() && top.cost < sec_goal.cost) {
+        if (!known(top.pos) && top.cost < sec_goal.cost) {
             sec_goal = top;
         }
         if (tri_goal.wave < top.wave || (tri_goal.wave == top.wave && top.cost < tri_goal.cost)) {
             tri_goal = top;
         }
 
-        for (auto &&place : places(top.pos)) {
-            auto &&near = places(place);
-            if (_knowledge->blocked.find(place) == _knowledge->blocked.end() &&
-                _knowledge->negative.find(place) == _knowledge->negative.end() &&
-                (_knowledge->values.find(place) != _knowledge->values.end() ||
-                 std::any_of(near.begin(), near.end(),
-                             [&](auto &&_p) {
-                                 return _knowledge->values.find(_p) != _knowledge->values.end();
-                             }
-            ))) {
-                int cost = (_knowledge->positive.find(place) == _knowledge->positive.end()) * 50 + 
-                           (_knowledge->negative.find(place) != _knowledge->negative.end()) * 100000000;
-                if (visited.find(place) == visited.end() &&
-                    (costs.find(place) == costs.end() ||
-                     costs[place] > cost + costs[top.pos])) {
+        int top_cost = scratch.cost[index(top.pos.y, top.pos.x)];
+        int around_count = places(top.pos, around);
+        for (int a = 0; a < around_count; ++a) {
+            auto &&place = around[a];
+            // wszystkie rodzaje wiedzy o polu jednym odczytem kafelka
+            const unsigned int place_planes = _knowledge.planes(place);
+            if (place_planes & (1 << KnowledgeTiles::Blocked | 1 << KnowledgeTiles::Negative)) {
+                continue;
+            }
+            int near_count = places(place, near);
+            if ((place_planes >> KnowledgeTiles::Known & 1) || std::any_of(near, near + near_count, known)) {
+                int cost = !(place_planes >> KnowledgeTiles::Positive & 1) * 50;
+                int idx = index(place.y, place.x);
+                if (scratch.stamp[idx] != scratch.current || scratch.cost[idx] > cost + top_cost) {
                     int heur_cost = euklid_dist(place, _end);
-                    costs[place] = cost + costs[top.pos];
-                    heap.insert(heap_data{ costs[place] + heur_cost, place, top.wave + 1 });
-                    parent[place] = top.pos;
+                    scratch.stamp[idx] = scratch.current;
+                    scratch.cost[idx] = cost + top_cost;
+                    scratch.parent[idx] = top.pos;
+                    push(heap_data{ scratch.cost[idx] + heur_cost, place, top.wave + 1, order++ });
                 }
             }
         }
     }
     
-    std::vector<Vec2> path;
+    _path.clear();
+
+    auto cost_of = [&](Vec2 const &_p) { return scratch.cost[index(_p.y, _p.x)]; };
 
-    _total_cost = costs.find(pri_goal.pos) != costs.end() ? costs[pri_goal.pos] :
-        costs.find(sec_goal.pos) != costs.end() ? costs[sec_goal.pos] :
-        costs.find(tri_goal.pos) != costs.end() ? costs[tri_goal.pos] : 0;
+    _total_cost = has_cost(pri_goal.pos) ? cost_of(pri_goal.pos) :
+                  has_cost(sec_goal.pos) ? cost_of(sec_goal.pos) :
+                  has_cost(tri_goal.pos) ? cost_of(tri_goal.pos) : 0;
 
-    auto goal = costs.find(pri_goal.pos) != costs.end() ? pri_goal.pos :
-                costs.find(sec_goal.pos) != costs.end() ? sec_goal.pos : tri_goal.pos;
+    auto goal = has_cost(pri_goal.pos) ? pri_goal.pos :
+                has_cost(sec_goal.pos) ? sec_goal.pos : tri_goal.pos;
 
-    while (goal != parent[goal]) {
-        path.push_back(goal);
-        goal = parent[goal];
+    if (!has_cost(goal)) {
+        return;
     }
 
-    return path;
+    while (goal != scratch.parent[index(goal.y, goal.x)]) {
+        _path.push_back(goal);
+        goal = scratch.parent[index(goal.y, goal.x)];
+    }
 }
 
 
 void Map::change_field(Vec2 const &_position, Field _field)
 {
-    fields[_position.y][_position.x] = _field;
+    if (_position.x < 0 || _position.x >= width || _position.y < 0 || _position.y >= height) {
+        return;
+    }
+    set_field(_position, _field, FieldChange::Edit);
+}
+
+bool Map::consume(Vec2 const &_position, int _capacity)
+{
+    int &capacity = capacities[index(_position.y, _position.x)];
+    if (capacity == no_capacity) {
+        capacity = _capacity;
+    }
+    if (--capacity >= 0) {
+        return false;
+    }
+
+    capacity = no_capacity;
+    set_field(_position, Field::Empty, FieldChange::Depletion);
+    return true;
 }
 
 Field Map::get_field(Vec2 const &_pos) const
 {
-    return fields[_pos.y][_pos.x];
+    return fields[index(_pos.y, _pos.x)];
 }
 
 std::vector<Vec2> Map::places(Vec2 const &_pos) const
 {
-    auto tmp = std::vector<Vec2>{
+    Vec2 near[6];
+    int count = places(_pos, near);
+    return std::vector<Vec2>(near, near + count);
+}
+
+int Map::places(Vec2 const &_pos, Vec2 *_near) const
+{
+    const Vec2 candidates[6] = {
         { _pos.y, _pos.x - 1 },
         { _pos.y, _pos.x + 1 },
         { _pos.y - 1, _pos.x - 1 + _pos.y % 2 },
@@ -162,13 +428,14 @@ std::vector<Vec2> Map::places(Vec2 const &_pos) const
         { _pos.y + 1, _pos.x - 1 + _pos.y % 2 },
         { _pos.y + 1, _pos.x + _pos.y % 2 }
     };
-    
-    tmp.erase(std::remove_if(tmp.begin(), tmp.end(), 
-                             [=](Vec2 const &_v) {
-                                 return _v.x < 0 || _v.x >= width || _v.y < 0 || _v.y >= height;
-                             }), tmp.end());
-    
-    return tmp;
+
+    int count = 0;
+    for (auto &&c : candidates) {
+        if (c.x >= 0 && c.x < width && c.y >= 0 && c.y < height) {
+            _near[count++] = c;
+        }
+    }
+    return count;
 }
 
 Vec2 Map::dimensions() const
@@ -181,54 +448,50 @@ Vec2 Map::start() const
     return population;
 }
 
-void Map::set_agent_view(Agent const *_agent_view)
+unsigned int Map::epoch() const
 {
-    agent_view = _agent_view;
+    return current_epoch;
 }
 
-void Map::draw(sf::RenderTarget &_target, sf::RenderStates _states) const
+unsigned int Map::modified_at(Vec2 const &_pos) const
 {
-    sf::CircleShape shp(25, 6);
-    shp.setOutlineThickness(2.0f);
-    shp.setOutlineColor(sf::Color::White);
+    return modified[index(_pos.y, _pos.x)];
+}
 
-    const double radius = std::ceil(std::sqrt(3) * 25);
+void Map::subscribe(std::weak_ptr<std::vector<FieldChange>> _subscriber)
+{
+    auto added = _subscriber.lock();
+    for (auto &&s : subscribers) {
+        if (s.lock() == added) {
+            return;
+        }
+    }
+    subscribers.push_back(std::move(_subscriber));
+}
 
-    for (int i = 0; i < height; i++) {
-        for (int j = 0; j < width; j++) {
-            auto &place = fields[i][j];
+// -----
 
-            shp.setPosition(hex_position(radius, i, j));
-            int r = 255, g = 255, b = 255, a = 255, k = -1;
-            if (agent_view) {
-                k = agent_view->know_of(Vec2(i, j));
-                a = (k > 0) * 155 + 100;
-                if (k) {
-                    r = 176; g = 226; b = 255;
-                }
-            }
+void Map::set_field(Vec2 const &_position, Field _field, FieldChange::Cause _cause)
+{
+    Field &field = fields[index(_position.y, _position.x)];
+    const FieldChange change{ _position, field, _field, _cause };
+    field = _field;
 
-            if (k == 4) {
-                shp.setFillColor(sf::Color(220, 220, 220, 255));
-            } if (k == 3) {
-                shp.setFillColor(sf::Color(173, 255, 47, 255));
-            } else if (k == 2) {
-                shp.setFillColor(sf::Color(255, 140, 0, 255));
-            } else if (place == Field::Blocked) {
-                shp.setFillColor(sf::Color(190, 190, 190, a));
-            } else if (place == Field::Empty) {
-                shp.setFillColor(sf::Color(r, g, b, a));
-            } else if (place == Field::Food) {
-                shp.setFillColor(sf::Color(106, 196, 49, a));
-            } else if (place == Field::Danger) {
-                shp.setFillColor(sf::Color(224, 38, 38, a));
-            } else if (place == Field::Water) {
-                shp.setFillColor(sf::Color(49, 123, 196, a));
-            } else if (place == Field::Population) {
-                shp.setFillColor(sf::Color(176, 86, 232, a));
-            }
+    modified[index(_position.y, _position.x)] = ++current_epoch;
+    journal[current_epoch % journal.size()] = change;
 
-            _target.draw(shp, _states);
+    subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(), [&](auto &&_s) {
+        if (auto changes = _s.lock()) {
+            changes->push_back(change);
+            return false;
         }
-    }
+        return true;
+    }), subscribers.end());
+}
+
+void Map::reset_fields()
+{
+    capacities.assign(fields.size(), no_capacity);
+    modified.assign(fields.size(), ++current_epoch);
+    journal_begin = current_epoch;
 }
\ No newline at end of file
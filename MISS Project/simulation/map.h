@@ -16,7 +16,7 @@ class Agent;
 /**
  * Enum opisujacy pola dostepne na mapie.
  */
-enum class Field
+enum class Field : unsigned char
 {
     Empty,
     Food,
@@ -28,10 +28,44 @@ enum class Field
 };
 
 
+/**
+ * Naglowek binarnego formatu mapy (.mpb)
+ * Po naglowku zapisane sa pola mapy wierszami, po dwa pola na bajt
+ * (mlodsze 4 bity - pole o parzystym indeksie, starsze - o nieparzystym).
+ */
+struct BinaryMapHeader
+{
+    char            magic[4];   // "MSMP"
+    unsigned int    version;
+    unsigned int    width;
+    unsigned int    height;
+    int             start_y;
+    int             start_x;
+};
+
+
+/**
+ * Zmiana pola mapy przekazywana odbiorcom zmian
+ */
+struct FieldChange
+{
+    enum Cause : unsigned char
+    {
+        Edit,       // zmiana terenu lub edycja mapy
+        Depletion,  // wyczerpanie zasobu pola
+    };
+
+    Vec2    pos;
+    Field   previous;
+    Field   field;
+    Cause   cause;
+};
+
+
 /**
  * Klasa odpowiedzialna za przechowywanie informacji o mapie i znajdowanie sciezek
  */
-class Map : public sf::Drawable
+class Map
 {
 public:
     /**
@@ -46,19 +80,41 @@ public:
     
     /**
      * Metoda zluzaca do wczytywania mapy z pliku
+     * Format pliku (tekstowy .mp lub binarny .mpb) rozpoznawany jest po naglowku.
      * @param _file nazwa pliku z mapa
+     * @return informacja czy mapa zostala poprawnie wczytana
      */
-    void load(std::string const &_file);
+    bool load(std::string const &_file);
 
     /**
-     * Metoda sluzaca do wyznaczania sciezki na mapie
+     * Metoda zapisujaca mape do pliku
+     * Pliki z rozszerzeniem .mpb zapisywane sa w formacie binarnym, pozostale w tekstowym.
+     * @param _file nazwa pliku
+     * @return informacja czy mapa zostala poprawnie zapisana
+     */
+    bool save(std::string const &_file) const;
+
+    /**
+     * Metoda tworzaca mape z podanych pol
+     * @param dimensions wymiary mapy (wysokosc, szerokosc)
+     * @param fields pola mapy zapisane wierszami
+     * @param start miejsce startowe populacji
+     */
+    void create(Vec2 const &, std::vector<Field>, Vec2 const &);
+
+    /**
+     * Metoda sluzaca do wyznaczania sciezki na mapie.
+     * Koszty i poprzedniki trzymane sa w gestych tablicach wielokrotnego uzytku (osobnych dla kazdego watku),
+     * wiec wyszukiwanie nie alokuje pamieci.
      * @param _start poczatek sciezki
      * @param _end koniec sciezki
      * @param _knowledge wiedza do wyznacznia trasy
      * @param out _total_cost calkowity koszt trasy
-     * @return path wyznaczona sciezka
+     * @param out _path wyznaczona sciezka (od konca do poczatku, bez pola startowego)
+     * @param _avoid pola omijane niezaleznie od wiedzy (np. jeszcze niewprowadzone zmiany wiedzy)
      */
-    std::vector<Vec2> search_path(Vec2 const &_start, Vec2 const &_end, std::shared_ptr<Knowledge> _knowledge, int &_total_cost) const;
+    void search_path(Vec2 const &_start, Vec2 const &_end, Knowledge const &_knowledge, int &_total_cost, std::vector<Vec2> &_path,
+                     std::vector<Vec2> const *_avoid = nullptr) const;
 
     /**
      * Metoda pozwala na zmiane typu danego pola
@@ -67,6 +123,47 @@ public:
      */
     void change_field(Vec2 const &, Field);
 
+    /**
+     * Metoda zuzywa jednostke zasobu pola (jedzenia, wody lub zagrozenia).
+     * Pojemnosc pola ustawiana jest przy pierwszym uzyciu, a wyczerpane pole staje sie puste.
+     * @param pos miejsce
+     * @param capacity poczatkowa pojemnosc pola
+     * @return informacja czy zasob pola zostal wyczerpany
+     */
+    bool consume(Vec2 const &, int);
+
+    /**
+     * Metoda zwraca epoke mapy - numer ostatniej zmiany pola (rosnie z kazda zmiana)
+     * @return epoka
+     */
+    unsigned int epoch() const;
+
+    /**
+     * Metoda zwraca epoke ostatniej zmiany pola
+     * @param pos miejsce
+     * @return epoka (epoka wczytania mapy dla pola niezmienianego)
+     */
+    unsigned int modified_at(Vec2 const &) const;
+
+    /**
+     * Metoda wywoluje funkcje dla zmian nowszych niz dana epoka (w kolejnosci zmian).
+     * Dziennik pamieta ostatnie journal_size zmian - starsze trzeba sprawdzac epokami pol.
+     * @param since epoka
+     * @param f funkcja przyjmujaca zmiane pola
+     * @return informacja czy dziennik zawiera wszystkie zmiany nowsze niz dana epoka
+     */
+    template <typename F>
+    bool changes_since(unsigned int _since, F _f) const
+    {
+        if (_since < journal_begin || current_epoch - _since > journal.size()) {
+            return false;
+        }
+        for (unsigned int e = _since + 1; e <= current_epoch; ++e) {
+            _f(journal[e % journal.size()]);
+        }
+        return true;
+    }
+
     /**
      * Metoda pozwala pobrac typ pola w danym miejscu
      * @param place miejsce
@@ -81,6 +178,14 @@ public:
      */
     std::vector<Vec2> places(Vec2 const &) const;
 
+    /**
+     * Metoda wypisuje otoczenie danego miejsca do tablicy (bez alokacji)
+     * @param place miejsce
+     * @param out near tablica na co najwyzej 6 miejsc
+     * @return ilosc pobliskich miejsc
+     */
+    int places(Vec2 const &, Vec2 *) const;
+
     /**
      * Metoda zwraca wymiary mapy
      * @return wymiary
@@ -95,24 +200,67 @@ public:
     
     // -----
     /**
-     * Metoda ustawia podglad na agencie
-     * @param wskaznik do agenta
+     * Metoda dodaje odbiorce zmian mapy (np. podglad, bufor sciezek) - dopisywane sa do niego zmiany pol.
+     * Odbiorca usuwany jest po zwolnieniu jego tablicy.
+     * @param subscriber odbiorca zmian
+     */
+    void subscribe(std::weak_ptr<std::vector<FieldChange>>);
+
+protected:
+    /**
+     * Metoda parsujaca mape w formacie tekstowym (jeden przebieg z walidacja)
+     * @param data dane pliku
+     * @param size rozmiar danych
+     * @return informacja czy mapa zostala poprawnie wczytana
+     */
+    bool load_text(char const *, std::size_t);
+
+    /**
+     * Metoda parsujaca mape w formacie binarnym
+     * @param data dane pliku
+     * @param size rozmiar danych
+     * @return informacja czy mapa zostala poprawnie wczytana
      */
-    void set_agent_view(Agent const *);
+    bool load_binary(char const *, std::size_t);
 
     /**
-     * Metoda z biblioteki SFML sluzaca do rysowania na oknie
+     * Metoda zwraca indeks pola w wektorze pol
+     * @param y wiersz
+     * @param x kolumna
+     * @return indeks
      */
-    virtual void draw(sf::RenderTarget &, sf::RenderStates) const override;
+    int index(int _y, int _x) const { return _y * width + _x; }
+
+    /**
+     * Metoda zmienia pole i przekazuje zmiane odbiorcom
+     * @param pos miejsce (na mapie)
+     * @param field nowy typ
+     * @param cause przyczyna zmiany
+     */
+    void set_field(Vec2 const &, Field, FieldChange::Cause);
+
+    /**
+     * Metoda przygotowuje pojemnosci i epoki pol nowo wczytanej mapy (wszystkie pola sa zmienione)
+     */
+    void reset_fields();
 
 private:
-    std::vector<std::vector<Field>> fields;
+    static const int no_capacity = -1;      // pole, ktorego zasob nie byl jeszcze uzywany
+    static const std::size_t journal_size = 256;
+
+    std::vector<Field> fields;
+    std::vector<int> capacities;            // pozostaly zasob pola
+    std::vector<unsigned int> modified;     // epoka ostatniej zmiany pola
 
     int width;
     int height;
 
     Vec2 population;
 
+    unsigned int current_epoch;
+    unsigned int journal_begin;             // epoka, od ktorej dziennik jest kompletny
+    std::vector<FieldChange> journal;       // bufor cykliczny - zmiana z epoki e pod indeksem e % journal_size
+
     // -----
-    Agent const *agent_view;
+    std::vector<std::weak_ptr<std::vector<FieldChange>>> subscribers;
 };
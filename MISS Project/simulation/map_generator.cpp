@@ -0,0 +1,170 @@
+#include "map_generator.h"
+
+#include <deque>
+#include <algorithm>
+
+namespace
+{
+    /**
+     * Funkcja zwraca indeksy sasiadow pola (y, x), pomijajac pola spoza mapy
+     * @return ilosc sasiadow zapisanych do out
+     */
+    int neighbours(int _y, int _x, int _height, int _width, int _out[6])
+    {
+        const int dy[6] = { 0, 0, -1, -1, 1, 1 };
+        const int dx[6] = { -1, 1, -1 + _y % 2, _y % 2, -1 + _y % 2, _y % 2 };
+
+        int count = 0;
+        for (int k = 0; k < 6; ++k) {
+            int ny = _y + dy[k], nx = _x + dx[k];
+            if (ny >= 0 && ny < _height && nx >= 0 && nx < _width) {
+                _out[count++] = ny * _width + nx;
+            }
+        }
+        return count;
+    }
+
+    /**
+     * Kwadrat odleglosci miedzy srodkami pol w geometrii heksagonalnej (sasiedzi w odleglosci 1)
+     */
+    double hex_distance2(int _a, int _b, int _width)
+    {
+        int ay = _a / _width, ax = _a % _width;
+        int by = _b / _width, bx = _b % _width;
+        double dx = (ax + 0.5 * (ay % 2)) - (bx + 0.5 * (by % 2));
+        double dy = (ay - by) * 0.8660254037844386;
+        return dx * dx + dy * dy;
+    }
+}
+
+Map generate_map(MapGeneratorOptions const &_opts)
+{
+    const int height = std::max(1, _opts.height);
+    const int width = std::max(1, _opts.width);
+    const int cells = height * width;
+
+    RandomStream rng(_opts.seed);
+    std::vector<Field> fields(cells, Field::Empty);
+
+    Vec2 start = _opts.start;
+    if (start.y < 0 || start.y >= height || start.x < 0 || start.x >= width) {
+        start = Vec2(height / 2, width / 2);
+    }
+    const int start_idx = start.y * width + start.x;
+
+    // miejsce startowe i jego otoczenie pozostaja puste
+    std::vector<char> reserved(cells, 0);
+    int near[6];
+    reserved[start_idx] = 1;
+    for (int k = 0, n = neighbours(start.y, start.x, height, width, near); k < n; ++k) {
+        reserved[near[k]] = 1;
+    }
+
+    // -----
+
+    const std::pair<Field, double> layers[] = {
+        { Field::Blocked, _opts.blocked_density },
+        { Field::Danger, _opts.danger_density },
+        { Field::Water, _opts.water_density },
+        { Field::Food, _opts.food_density },
+    };
+
+    const int cluster = std::max(1, _opts.cluster_size);
+    std::vector<int> frontier;
+    int free_cells = cells - static_cast<int>(std::count(reserved.begin(), reserved.end(), 1));
+
+    for (auto &&layer : layers) {
+        int target = std::min(free_cells, static_cast<int>(clamp(0.0, 1.0, layer.second) * cells));
+        int placed = 0;
+        int attempts = 0;
+
+        while (placed < target && attempts++ < 4 * cells) {
+            int seed_idx = rng.next_int(0, cells - 1);
+            if (reserved[seed_idx] || fields[seed_idx] != Field::Empty) {
+                continue;
+            }
+
+            frontier.clear();
+            frontier.push_back(seed_idx);
+            int blob = 0;
+            while (!frontier.empty() && blob < cluster && placed < target) {
+                int pick = rng.next_int(0, static_cast<int>(frontier.size()) - 1);
+                int idx = frontier[pick];
+                frontier[pick] = frontier.back();
+                frontier.pop_back();
+
+                if (reserved[idx] || fields[idx] != Field::Empty) {
+                    continue;
+                }
+                fields[idx] = layer.first;
+                ++blob;
+                ++placed;
+
+                for (int k = 0, n = neighbours(idx / width, idx % width, height, width, near); k < n; ++k) {
+                    frontier.push_back(near[k]);
+                }
+            }
+        }
+        free_cells -= placed;
+    }
+
+    fields[start_idx] = Field::Population;
+
+    // -----
+    // zapewnienie spojnosci: kazde pole niebedace przeszkoda musi byc osiagalne ze startu
+
+    std::vector<char> reached(cells, 0);
+    std::deque<int> queue;
+
+    auto flood = [&]() {
+        while (!queue.empty()) {
+            int idx = queue.front();
+            queue.pop_front();
+            for (int k = 0, n = neighbours(idx / width, idx % width, height, width, near); k < n; ++k) {
+                if (!reached[near[k]] && fields[near[k]] != Field::Blocked) {
+                    reached[near[k]] = 1;
+                    queue.push_back(near[k]);
+                }
+            }
+        }
+    };
+
+    reached[start_idx] = 1;
+    queue.push_back(start_idx);
+    flood();
+
+    for (int idx = 0; idx < cells; ++idx) {
+        if (reached[idx] || fields[idx] == Field::Blocked) {
+            continue;
+        }
+
+        // przekopanie korytarza w strone startu az do osiagnietego obszaru
+        int current = idx;
+        while (!reached[current]) {
+            reached[current] = 1;
+            queue.push_back(current);
+
+            int best = current;
+            double best_dist = hex_distance2(current, start_idx, width);
+            for (int k = 0, n = neighbours(current / width, current % width, height, width, near); k < n; ++k) {
+                double dist = hex_distance2(near[k], start_idx, width);
+                if (dist < best_dist) {
+                    best_dist = dist;
+                    best = near[k];
+                }
+            }
+            if (best == current) {
+                break;
+            }
+            if (fields[best] == Field::Blocked) {
+                fields[best] = Field::Empty;
+            }
+            current = best;
+        }
+        flood();
+    }
+
+    Map map;
+    map.create(Vec2(height, width), std::move(fields), start);
+    return map;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "map.h"
+
+/**
+ * Struktura trzymajaca parametry generatora map
+ */
+struct MapGeneratorOptions
+{
+    // wymiary mapy
+    int width = 100;
+    int height = 100;
+
+    // ziarno generatora (ta sama wartosc daje ta sama mape)
+    unsigned long long seed = 1;
+
+    // udzial pol danego typu w mapie
+    double food_density = 0.03;
+    double water_density = 0.03;
+    double danger_density = 0.03;
+    double blocked_density = 0.10;
+
+    // srednia wielkosc skupisk pol jednego typu (1 - pola rozrzucone pojedynczo)
+    int cluster_size = 6;
+
+    // miejsce startowe populacji, (-1, -1) oznacza srodek mapy
+    Vec2 start = Vec2(-1, -1);
+};
+
+/**
+ * Funkcja generujaca losowa mape heksagonalna o zadanych parametrach.
+ * Kazde pole nie bedace przeszkoda jest osiagalne z miejsca startowego populacji.
+ * @param opts parametry generatora
+ * @return wygenerowana mapa
+ */
+Map generate_map(MapGeneratorOptions const &);
\ No newline at end of file
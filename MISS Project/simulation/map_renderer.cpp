@@ -0,0 +1,245 @@
+#include "map_renderer.h"
+
+#include <cmath>
+#include <algorithm>
+#include <array>
+
+namespace
+{
+    // wierzcholki szesciokata o wierzcholku skierowanym do gory (jak sf::CircleShape(25, 6))
+    std::array<sf::Vector2f, 6> hex_corners()
+    {
+        const float hex_radius = 24.0f;
+
+        std::array<sf::Vector2f, 6> corners;
+        for (int k = 0; k < 6; ++k) {
+            float angle = static_cast<float>(k * 3.14159265358979 / 3.0 - 3.14159265358979 / 2.0);
+            corners[k] = sf::Vector2f(25.0f + hex_radius * std::cos(angle), 25.0f + hex_radius * std::sin(angle));
+        }
+        return corners;
+    }
+}
+
+MapRenderer::MapRenderer()
+    : width(0)
+    , height(0)
+    , chunks_x(0)
+    , chunks_y(0)
+    , lod_scale(1)
+    , lod_width(0)
+    , lod_height(0)
+    , lod_dirty_begin(0)
+    , lod_dirty_end(0)
+{
+}
+
+void MapRenderer::reset(Vec2 const &_dimensions, sf::Color const &_color)
+{
+    width = _dimensions.x;
+    height = _dimensions.y;
+    chunks_x = (width + chunk_size - 1) / chunk_size;
+    chunks_y = (height + chunk_size - 1) / chunk_size;
+
+    const double radius = std::ceil(std::sqrt(3) * 25);
+
+    // siatki poprzedniej mapy wracaja do puli, a nowe budowane sa dopiero przy rysowaniu
+    release_chunks();
+    meshes_of.assign(chunks_x * chunks_y, -1);
+
+    // tekstura podgladu nie moze przekroczyc maksymalnego rozmiaru tekstury
+    int max_size = static_cast<int>(sf::Texture::getMaximumSize());
+    lod_scale = std::max(1, (std::max(width, height) + max_size - 1) / max_size);
+    lod_width = (width + lod_scale - 1) / lod_scale;
+    lod_height = (height + lod_scale - 1) / lod_scale;
+    lod_pixels.resize(lod_width * lod_height * 4);
+    lod_texture.create(lod_width, lod_height);
+    lod_texture.setSmooth(false);
+    lod_sprite.setTexture(lod_texture, true);
+    lod_sprite.setScale(static_cast<float>(width * radius / lod_width), static_cast<float>(height * (radius - 4) / lod_height));
+
+    fill(_color);
+}
+
+void MapRenderer::build_cell(sf::VertexArray &_vertices, int _base, Vec2 const &_pos, sf::Color const &_color)
+{
+    const double radius = std::ceil(std::sqrt(3) * 25);
+    static const auto corners = hex_corners();
+
+    Vec2 pos = hex_position(radius, _pos.y, _pos.x);
+    sf::Vector2f origin(static_cast<float>(pos.x), static_cast<float>(pos.y));
+
+    for (int t = 0; t < 4; ++t) {
+        _vertices[_base + t * 3 + 0] = sf::Vertex(origin + corners[0], _color);
+        _vertices[_base + t * 3 + 1] = sf::Vertex(origin + corners[t + 1], _color);
+        _vertices[_base + t * 3 + 2] = sf::Vertex(origin + corners[t + 2], _color);
+    }
+}
+
+float MapRenderer::cell_pixels(sf::RenderTarget const &_target)
+{
+    const float radius = std::ceil(std::sqrt(3.0f) * 25.0f);
+    auto &&view = _target.getView();
+    return radius * static_cast<float>(_target.getSize().x) / std::max(1.0f, view.getSize().x);
+}
+
+MapRenderer::ChunkRange MapRenderer::visible_chunks(sf::View const &_view, int _chunks_x, int _chunks_y)
+{
+    sf::FloatRect visible(_view.getCenter().x - _view.getSize().x / 2.0f, _view.getCenter().y - _view.getSize().y / 2.0f,
+                          _view.getSize().x, _view.getSize().y);
+
+    // zakres fragmentow przecinajacych widok (z zapasem na przesuniecie nieparzystych wierszy)
+    const float radius = std::ceil(std::sqrt(3.0f) * 25.0f);
+    const float chunk_w = chunk_size * radius;
+    const float chunk_h = chunk_size * (radius - 4.0f);
+
+    ChunkRange range;
+    range.x_begin = std::max(0, static_cast<int>(std::floor((visible.left - radius - 50.0f) / chunk_w)));
+    range.x_end = std::min(_chunks_x, static_cast<int>(std::floor((visible.left + visible.width) / chunk_w)) + 1);
+    range.y_begin = std::max(0, static_cast<int>(std::floor((visible.top - 50.0f) / chunk_h)));
+    range.y_end = std::min(_chunks_y, static_cast<int>(std::floor((visible.top + visible.height) / chunk_h)) + 1);
+    return range;
+}
+
+Vec2 MapRenderer::dimensions() const
+{
+    return Vec2(height, width);
+}
+
+void MapRenderer::set_color(Vec2 const &_pos, sf::Color const &_color)
+{
+    if (_pos.x < 0 || _pos.x >= width || _pos.y < 0 || _pos.y >= height) {
+        return;
+    }
+
+    colors[_pos.y * width + _pos.x] = _color;
+
+    int mesh = meshes_of[(_pos.y / chunk_size) * chunks_x + _pos.x / chunk_size];
+    if (mesh != -1) {
+        auto &vertices = meshes[mesh];
+        int base = ((_pos.y % chunk_size) * chunk_size + _pos.x % chunk_size) * vertices_per_cell;
+        for (int v = 0; v < vertices_per_cell; ++v) {
+            vertices[base + v].color = _color;
+        }
+    }
+
+    int row = _pos.y / lod_scale;
+    auto pixel = &lod_pixels[(row * lod_width + _pos.x / lod_scale) * 4];
+    pixel[0] = _color.r; pixel[1] = _color.g; pixel[2] = _color.b; pixel[3] = _color.a;
+
+    if (lod_dirty_begin == lod_dirty_end) {
+        lod_dirty_begin = row;
+        lod_dirty_end = row + 1;
+    } else {
+        lod_dirty_begin = std::min(lod_dirty_begin, row);
+        lod_dirty_end = std::max(lod_dirty_end, row + 1);
+    }
+}
+
+void MapRenderer::fill(sf::Color const &_color)
+{
+    // siatki zostana zbudowane z nowych kolorow przy rysowaniu
+    colors.assign(width * height, _color);
+    release_chunks();
+
+    for (std::size_t i = 0; i < lod_pixels.size(); i += 4) {
+        lod_pixels[i + 0] = _color.r;
+        lod_pixels[i + 1] = _color.g;
+        lod_pixels[i + 2] = _color.b;
+        lod_pixels[i + 3] = _color.a;
+    }
+    lod_dirty_begin = 0;
+    lod_dirty_end = lod_height;
+}
+
+sf::VertexArray const & MapRenderer::chunk_mesh(int _chunk) const
+{
+    if (meshes_of[_chunk] != -1) {
+        return meshes[meshes_of[_chunk]];
+    }
+
+    int mesh;
+    if (free_meshes.empty()) {
+        mesh = static_cast<int>(meshes.size());
+        meshes.emplace_back(sf::Triangles, chunk_size * chunk_size * vertices_per_cell);
+        mesh_chunks.push_back(-1);
+    } else {
+        mesh = free_meshes.back();
+        free_meshes.pop_back();
+    }
+    meshes_of[_chunk] = mesh;
+    mesh_chunks[mesh] = _chunk;
+
+    auto &vertices = meshes[mesh];
+    int y_begin = (_chunk / chunks_x) * chunk_size;
+    int x_begin = (_chunk % chunks_x) * chunk_size;
+
+    // fragment na krawedzi mapy - pola poza mapa to zdegenerowane trojkaty (siatka mogla nalezec do innego fragmentu)
+    if (y_begin + chunk_size > height || x_begin + chunk_size > width) {
+        for (std::size_t v = 0; v < vertices.getVertexCount(); ++v) {
+            vertices[v] = sf::Vertex();
+        }
+    }
+
+    for (int i = y_begin; i < std::min(height, y_begin + chunk_size); ++i) {
+        for (int j = x_begin; j < std::min(width, x_begin + chunk_size); ++j) {
+            int base = ((i - y_begin) * chunk_size + j - x_begin) * vertices_per_cell;
+            build_cell(vertices, base, Vec2(i, j), colors[i * width + j]);
+        }
+    }
+    return vertices;
+}
+
+void MapRenderer::evict_chunks(ChunkRange const &_range) const
+{
+    for (std::size_t mesh = 0; mesh < meshes.size(); ++mesh) {
+        int chunk = mesh_chunks[mesh];
+        if (chunk == -1) {
+            continue;
+        }
+        int cy = chunk / chunks_x;
+        int cx = chunk % chunks_x;
+        if (cy < _range.y_begin - 1 || cy > _range.y_end || cx < _range.x_begin - 1 || cx > _range.x_end) {
+            meshes_of[chunk] = -1;
+            mesh_chunks[mesh] = -1;
+            free_meshes.push_back(static_cast<int>(mesh));
+        }
+    }
+}
+
+void MapRenderer::release_chunks() const
+{
+    for (std::size_t mesh = 0; mesh < meshes.size(); ++mesh) {
+        if (mesh_chunks[mesh] != -1) {
+            meshes_of[mesh_chunks[mesh]] = -1;
+            mesh_chunks[mesh] = -1;
+            free_meshes.push_back(static_cast<int>(mesh));
+        }
+    }
+}
+
+void MapRenderer::upload_lod() const
+{
+    if (lod_dirty_begin < lod_dirty_end) {
+        lod_texture.update(&lod_pixels[lod_dirty_begin * lod_width * 4], lod_width, lod_dirty_end - lod_dirty_begin, 0, lod_dirty_begin);
+    }
+    lod_dirty_begin = lod_dirty_end = 0;
+}
+
+void MapRenderer::draw(sf::RenderTarget &_target, sf::RenderStates _states) const
+{
+    // przy duzym oddaleniu wystarczy tekstura z jednym pikselem na pole
+    if (cell_pixels(_target) < lod_cell_pixels) {
+        upload_lod();
+        _target.draw(lod_sprite, _states);
+        return;
+    }
+
+    auto range = visible_chunks(_target.getView(), chunks_x, chunks_y);
+    evict_chunks(range);
+
+    for (int cy = range.y_begin; cy < range.y_end; ++cy) {
+        for (int cx = range.x_begin; cx < range.x_end; ++cx) {
+            _target.draw(chunk_mesh(cy * chunks_x + cx), _states);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <vector>
+
+#include <SFML\Graphics.hpp>
+#include "utils.h"
+
+/**
+ * Klasa odpowiedzialna za rysowanie siatki heksagonalnej mapy.
+ * Geometria pol trzymana jest w tablicach wierzcholkow podzielonych na kwadratowe fragmenty,
+ * dzieki czemu kazdy fragment rysowany jest jednym wywolaniem, a zmiana pola wymaga
+ * jedynie podmiany kolorow jego wierzcholkow. Siatka fragmentu budowana jest z kolorow pol dopiero
+ * gdy fragment pojawi sie w widoku, a po jego opuszczeniu wraca do puli - pamiec i czas budowania
+ * zaleza od rozmiaru ekranu, nie mapy. Przy duzym oddaleniu cala mapa rysowana jest z tekstury
+ * (jeden piksel na pole).
+ */
+class MapRenderer : public sf::Drawable
+{
+public:
+    /**
+     * Ilosc pol w boku jednego fragmentu
+     */
+    static const int chunk_size = 32;
+
+    /**
+     * Ilosc wierzcholkow przypadajacych na jedno pole (4 trojkaty)
+     */
+    static const int vertices_per_cell = 12;
+
+    /**
+     * Rozmiar pola na ekranie (w pikselach) ponizej ktorego mapa rysowana jest z tekstury
+     */
+    static constexpr float lod_cell_pixels = 4.0f;
+
+    /**
+     * Zakres fragmentow (kolumn i wierszy) przecinajacych widok
+     */
+    struct ChunkRange
+    {
+        int x_begin, x_end;
+        int y_begin, y_end;
+    };
+
+    /**
+     * Konstruktor klasy
+     */
+    MapRenderer();
+
+    /**
+     * Metoda budujaca geometrie dla mapy o podanych wymiarach
+     * @param dimensions wymiary mapy
+     * @param color poczatkowy kolor pol
+     */
+    void reset(Vec2 const &, sf::Color const & = sf::Color::White);
+
+    /**
+     * Metoda zwraca wymiary mapy dla ktorej zbudowano geometrie
+     * @return wymiary
+     */
+    Vec2 dimensions() const;
+
+    /**
+     * Metoda ustawia kolor danego pola
+     * @param pos pozycja pola
+     * @param color kolor
+     */
+    void set_color(Vec2 const &, sf::Color const &);
+
+    /**
+     * Metoda ustawia wszystkie pola na jeden kolor
+     * @param color kolor
+     */
+    void fill(sf::Color const &);
+
+    /**
+     * Metoda z biblioteki SFML sluzaca do rysowania na oknie
+     */
+    virtual void draw(sf::RenderTarget &, sf::RenderStates) const override;
+
+    /**
+     * Metoda wyznacza rozmiar pola na ekranie
+     * @param target okno z aktualnym widokiem
+     * @return szerokosc pola w pikselach
+     */
+    static float cell_pixels(sf::RenderTarget const &);
+
+    /**
+     * Metoda wyznacza zakres fragmentow widocznych w widoku
+     * @param view widok
+     * @param chunks_x ilosc fragmentow w poziomie
+     * @param chunks_y ilosc fragmentow w pionie
+     * @return zakres fragmentow
+     */
+    static ChunkRange visible_chunks(sf::View const &, int, int);
+
+    /**
+     * Metoda zapisuje wierzcholki pola (vertices_per_cell kolejnych wierzcholkow)
+     * @param vertices tablica wierzcholkow fragmentu
+     * @param base indeks pierwszego wierzcholka pola
+     * @param pos pozycja pola
+     * @param color kolor wierzcholkow
+     */
+    static void build_cell(sf::VertexArray &, int, Vec2 const &, sf::Color const &);
+
+protected:
+    /**
+     * Metoda przesyla zmienione wiersze tekstury podgladu do karty graficznej
+     */
+    void upload_lod() const;
+
+    /**
+     * Metoda zwraca siatke fragmentu, budujac ja z kolorow pol gdy fragment nie ma siatki
+     * @param chunk indeks fragmentu
+     * @return siatka fragmentu
+     */
+    sf::VertexArray const & chunk_mesh(int) const;
+
+    /**
+     * Metoda zwraca do puli siatki fragmentow lezacych poza zakresem (z zapasem jednego fragmentu)
+     * @param range zakres widocznych fragmentow
+     */
+    void evict_chunks(ChunkRange const &) const;
+
+    /**
+     * Metoda zwraca do puli siatki wszystkich fragmentow
+     */
+    void release_chunks() const;
+
+private:
+    std::vector<sf::Color>  colors;     // kolory pol (zrodlo siatek fragmentow)
+
+    int width;
+    int height;
+    int chunks_x;
+    int chunks_y;
+
+    // siatki fragmentow w widoku - fragment bez siatki ma indeks -1, zwolnione siatki czekaja w puli
+    mutable std::vector<int>                meshes_of;
+    mutable std::vector<int>                mesh_chunks;
+    mutable std::vector<sf::VertexArray>    meshes;
+    mutable std::vector<int>                free_meshes;
+
+    // -----
+    // podglad mapy przy duzym oddaleniu (lod_scale x lod_scale pol na piksel)
+
+    std::vector<sf::Uint8>  lod_pixels;
+    int                     lod_scale;
+    int                     lod_width;
+    int                     lod_height;
+
+    mutable sf::Texture     lod_texture;
+    mutable sf::Sprite      lod_sprite;
+    mutable int             lod_dirty_begin;
+    mutable int             lod_dirty_end;
+};
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(std::string const &_file)
+    : begin(nullptr)
+    , length(0)
+    , opened(false)
+    , file_handle(INVALID_HANDLE_VALUE)
+    , mapping_handle(nullptr)
+{
+    file_handle = CreateFileA(_file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle, &file_size)) {
+        return;
+    }
+
+    length = static_cast<std::size_t>(file_size.QuadPart);
+    opened = true;
+
+    // pustego pliku nie da sie odwzorowac, ale jest on poprawnie otwarty
+    if (length == 0) {
+        return;
+    }
+
+    mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping_handle) {
+        opened = false;
+        return;
+    }
+
+    begin = static_cast<char const *>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    if (!begin) {
+        opened = false;
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (begin) {
+        UnmapViewOfFile(begin);
+    }
+    if (mapping_handle) {
+        CloseHandle(mapping_handle);
+    }
+    if (file_handle != INVALID_HANDLE_VALUE) {
+        CloseHandle(file_handle);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(std::string const &_file)
+    : begin(nullptr)
+    , length(0)
+    , opened(false)
+    , descriptor(-1)
+{
+    descriptor = open(_file.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        return;
+    }
+
+    struct stat file_stat;
+    if (fstat(descriptor, &file_stat) != 0) {
+        return;
+    }
+
+    length = static_cast<std::size_t>(file_stat.st_size);
+    opened = true;
+
+    if (length == 0) {
+        return;
+    }
+
+    void *ptr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    if (ptr == MAP_FAILED) {
+        opened = false;
+        return;
+    }
+
+    madvise(ptr, length, MADV_SEQUENTIAL);
+    begin = static_cast<char const *>(ptr);
+}
+
+MappedFile::~MappedFile()
+{
+    if (begin) {
+        munmap(const_cast<char *>(begin), length);
+    }
+    if (descriptor >= 0) {
+        close(descriptor);
+    }
+}
+
+#endif
+
+// -----
+
+bool MappedFile::is_open() const
+{
+    return opened;
+}
+
+char const* MappedFile::data() const
+{
+    return begin;
+}
+
+std::size_t MappedFile::size() const
+{
+    return length;
+}
\ No newline at end of file
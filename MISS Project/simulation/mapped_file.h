@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+/**
+ * Klasa odpowiedzialna za odwzorowanie pliku w pamieci (tylko do odczytu)
+ */
+class MappedFile
+{
+public:
+    /**
+     * Konstruktor otwierajacy i mapujacy plik
+     * @param file nazwa pliku
+     */
+    explicit MappedFile(std::string const &_file);
+
+    MappedFile(MappedFile const &) = delete;
+    MappedFile& operator=(MappedFile const &) = delete;
+
+    /**
+     * Destruktor zwalniajacy odwzorowanie
+     */
+    ~MappedFile();
+
+    /**
+     * Metoda sprawdza czy plik zostal poprawnie otwarty
+     * @return informacja czy plik jest dostepny
+     */
+    bool is_open() const;
+
+    /**
+     * Metoda zwraca wskaznik na poczatek danych pliku
+     * @return dane pliku
+     */
+    char const* data() const;
+
+    /**
+     * Metoda zwraca rozmiar pliku w bajtach
+     * @return rozmiar pliku
+     */
+    std::size_t size() const;
+
+private:
+    char const  *begin;
+    std::size_t length;
+    bool        opened;
+
+#ifdef _WIN32
+    void        *file_handle;
+    void        *mapping_handle;
+#else
+    int         descriptor;
+#endif
+};
\ No newline at end of file
@@ -0,0 +1,23 @@
+#include "overlay_renderer.h"
+
+OverlayRenderer::OverlayRenderer()
+    : visible(false)
+{
+}
+
+void OverlayRenderer::reset(Vec2 const &_dimensions)
+{
+    MapRenderer::reset(_dimensions, sf::Color::Transparent);
+}
+
+void OverlayRenderer::set_visible(bool _visible)
+{
+    visible = _visible;
+}
+
+void OverlayRenderer::draw(sf::RenderTarget &_target, sf::RenderStates _states) const
+{
+    if (visible) {
+        MapRenderer::draw(_target, _states);
+    }
+}
\ No newline at end of file
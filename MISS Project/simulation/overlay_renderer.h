@@ -0,0 +1,38 @@
+#pragma once
+
+#include "map_renderer.h"
+
+/**
+ * Klasa odpowiedzialna za rysowanie polprzezroczystej warstwy nad mapa (np. wiedzy podgladanego agenta).
+ * Fragmenty, podglad przy duzym oddaleniu i przesylanie zmienionych wierszy pochodza z MapRenderer -
+ * warstwa dodaje jedynie wlaczanie rysowania. Kolory pol maja kanal alfa, wiec warstwa rysowana jest
+ * z mieszaniem na wczesniej narysowanej mapie.
+ */
+class OverlayRenderer : public MapRenderer
+{
+public:
+    /**
+     * Konstruktor klasy
+     */
+    OverlayRenderer();
+
+    /**
+     * Metoda przygotowuje przezroczysta warstwe dla mapy o podanych wymiarach
+     * @param dimensions wymiary mapy
+     */
+    void reset(Vec2 const &);
+
+    /**
+     * Metoda wlacza lub wylacza rysowanie warstwy
+     * @param visible
+     */
+    void set_visible(bool);
+
+    /**
+     * Metoda z biblioteki SFML sluzaca do rysowania na oknie
+     */
+    virtual void draw(sf::RenderTarget &, sf::RenderStates) const override;
+
+private:
+    bool visible;
+};
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "path_planner.h"
+
+const std::size_t PathPlanner::no_ticket;
+
+PathPlanner::PathPlanner(Map const &_map, unsigned int _threads)
+    : map(_map)
+    , quit(false)
+    , dispatched(0)
+    , taken(0)
+    , finished(0)
+{
+    for (unsigned int i = 0; i < _threads; ++i) {
+        workers.emplace_back(&PathPlanner::work, this);
+    }
+}
+
+PathPlanner::~PathPlanner()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (auto &&w : workers) {
+        w.join();
+    }
+}
+
+void PathPlanner::reserve(std::size_t _count)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (taken == finished) {
+        requests.reserve(_count);
+    }
+}
+
+PathRequest PathPlanner::prepare()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (spare.empty()) {
+        return PathRequest{ Vec2(), Vec2(), nullptr, {}, {}, -1, false };
+    }
+    PathRequest request = std::move(spare.back());
+    spare.pop_back();
+    return request;
+}
+
+std::size_t PathPlanner::submit(PathRequest _request)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // watki robocze trzymaja wskazniki do zlecen - przed realokacja trzeba poczekac na wykonywane zlecenia
+    if (requests.size() == requests.capacity()) {
+        done.wait(lock, [&]() { return taken == finished; });
+    }
+    requests.push_back(std::move(_request));
+    return requests.size() - 1;
+}
+
+void PathPlanner::dispatch()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (dispatched == requests.size()) {
+            return;
+        }
+        dispatched = requests.size();
+    }
+    wake.notify_one();
+}
+
+void PathPlanner::wait_for(std::size_t _ticket)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&]() { return requests[_ticket].ready; });
+}
+
+std::vector<PathRequest> & PathPlanner::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    dispatched = requests.size();
+    wake.notify_all();
+
+    run(lock);
+    done.wait(lock, [&]() { return finished == requests.size(); });
+    return requests;
+}
+
+void PathPlanner::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto &&r : requests) {
+        r.knowledge.reset();
+        r.avoid.clear();
+        r.path.clear();
+        r.total_cost = -1;
+        r.ready = false;
+        spare.push_back(std::move(r));
+    }
+    requests.clear();
+    dispatched = taken = finished = 0;
+}
+
+// -----
+
+void PathPlanner::work()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [&]() { return quit || taken < dispatched; });
+        if (quit) {
+            return;
+        }
+        run(lock);
+    }
+}
+
+void PathPlanner::run(std::unique_lock<std::mutex> &_lock)
+{
+    while (taken < dispatched) {
+        PathRequest &request = requests[taken++];
+
+        _lock.unlock();
+        map.search_path(request.start, request.target, *request.knowledge, request.total_cost, request.path, &request.avoid);
+        _lock.lock();
+
+        request.ready = true;
+        ++finished;
+        done.notify_all();
+    }
+}
\ No newline at end of file
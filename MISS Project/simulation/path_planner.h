@@ -0,0 +1,120 @@
+#pragma once
+
+#include "map.h"
+#include "knowledge.h"
+#include "utils.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <memory>
+
+/**
+ * Zlecenie wyznaczenia sciezki dla agenta
+ */
+struct PathRequest
+{
+    Vec2                                start;
+    Vec2                                target;
+    std::shared_ptr<Knowledge const>    knowledge;  // wiedza zyje do odebrania wyniku, nawet po smierci agenta
+    std::vector<Vec2>                   avoid;      // pola omijane mimo wiedzy (bufor z puli planera)
+    std::vector<Vec2>                   path;       // wynik (bufor z puli planera)
+    int                                 total_cost;
+    bool                                ready;
+};
+
+/**
+ * Asynchroniczny planer sciezek - zlecenia wykonywane sa przez watki robocze,
+ * a symulacja w tym czasie obsluguje kolejnych agentow i konczy krok. Wyniki odbierane sa przez wait()
+ * na poczatku kolejnego kroku, w kolejnosci zlecen, wiec nie zaleza od ilosci watkow.
+ * Do czasu wykonania zlecenia wiedza agenta nie moze byc modyfikowana (patrz wait_for()).
+ */
+class PathPlanner
+{
+public:
+    static const std::size_t no_ticket = static_cast<std::size_t>(-1);
+
+    /**
+     * Konstruktor
+     * @param map mapa
+     * @param threads ilosc watkow roboczych
+     */
+    PathPlanner(Map const &, unsigned int);
+
+    PathPlanner(PathPlanner const &) = delete;
+    PathPlanner& operator=(PathPlanner const &) = delete;
+
+    /**
+     * Destruktor zatrzymujacy watki robocze
+     */
+    ~PathPlanner();
+
+    /**
+     * Metoda przygotowuje planer na zlecenia z jednego kroku
+     * @param count maksymalna ilosc zlecen w kroku
+     */
+    void reserve(std::size_t);
+
+    /**
+     * Metoda zwraca puste zlecenie z buforami z puli planera (do wypelnienia i submit())
+     * @return zlecenie
+     */
+    PathRequest prepare();
+
+    /**
+     * Metoda dodaje zlecenie do kolejki (wykonywane jest dopiero po dispatch() lub wait())
+     * @param request zlecenie
+     * @return numer zlecenia (wazny do clear())
+     */
+    std::size_t submit(PathRequest);
+
+    /**
+     * Metoda pozwala watkom roboczym wykonywac wszystkie dodane zlecenia
+     */
+    void dispatch();
+
+    /**
+     * Metoda czeka na wykonanie jednego dopuszczonego zlecenia (bez wykonywania innych zlecen)
+     * @param ticket numer zlecenia
+     */
+    void wait_for(std::size_t);
+
+    /**
+     * Metoda czeka na wykonanie wszystkich zlecen (watek wywolujacy rowniez je wykonuje)
+     * @return wykonane zlecenia w kolejnosci dodania (wazne do clear(), bufory sciezek mozna zamieniac)
+     */
+    std::vector<PathRequest> & wait();
+
+    /**
+     * Metoda usuwa odebrane zlecenia (ich bufory wracaja do puli)
+     */
+    void clear();
+
+protected:
+    /**
+     * Glowna petla watku roboczego
+     */
+    void work();
+
+    /**
+     * Metoda wykonuje kolejne dopuszczone zlecenia (wywolywana z zablokowanym mutexem)
+     * @param lock blokada mutexu
+     */
+    void run(std::unique_lock<std::mutex> &);
+
+private:
+    Map const                   &map;
+
+    std::vector<std::thread>    workers;
+    std::mutex                  mutex;
+    std::condition_variable     wake;
+    std::condition_variable     done;
+    bool                        quit;
+
+    std::vector<PathRequest>    requests;
+    std::vector<PathRequest>    spare;          // zlecenia z buforami do ponownego uzycia
+    std::size_t                 dispatched;     // ilosc zlecen dopuszczonych do wykonania
+    std::size_t                 taken;          // ilosc zlecen pobranych przez watki
+    std::size_t                 finished;       // ilosc wykonanych zlecen
+};
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+/**
+ * Tymczasowy wektor pobierany z puli danego watku.
+ * Po zniszczeniu obiektu wektor jest czyszczony i wraca do puli razem z zaalokowana pamiecia,
+ * wiec w ustalonym stanie symulacji bufory tymczasowe nie alokuja pamieci. Mozna jednoczesnie
+ * uzywac wielu buforow (pula rosnie do najwiekszej ilosci jednoczesnie uzywanych buforow).
+ */
+template <typename T>
+class ScratchVector
+{
+public:
+    ScratchVector()
+    {
+        auto &free = pool();
+        if (free.empty()) {
+            buffer.reset(new std::vector<T>());
+        } else {
+            buffer = std::move(free.back());
+            free.pop_back();
+        }
+    }
+
+    ~ScratchVector()
+    {
+        buffer->clear();
+        pool().push_back(std::move(buffer));
+    }
+
+    ScratchVector(ScratchVector const &) = delete;
+    ScratchVector& operator=(ScratchVector const &) = delete;
+
+    std::vector<T>& operator*() { return *buffer; }
+    std::vector<T>* operator->() { return buffer.get(); }
+
+private:
+    static std::vector<std::unique_ptr<std::vector<T>>>& pool()
+    {
+        thread_local std::vector<std::unique_ptr<std::vector<T>>> free;
+        return free;
+    }
+
+    std::unique_ptr<std::vector<T>> buffer;
+};
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "share_graph.h"
+#include "agent_store.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+    bool by_ids(ShareGraph::Edge const &_a, ShareGraph::Edge const &_b)
+    {
+        return _a.giver_id < _b.giver_id || (_a.giver_id == _b.giver_id && _a.receiver_id < _b.receiver_id);
+    }
+
+    /**
+     * Sortowanie przez zliczanie - po wywolaniu start[k] to poczatek kubelka k
+     * @param start liczniki kubelkow przesuniete o jeden (start[k + 1] = rozmiar kubelka k)
+     * @param count ilosc elementow
+     * @param key kubelek elementu
+     * @param place wstawienie elementu na pozycje
+     */
+    template <typename Key, typename Place>
+    void counting_sort(std::vector<std::size_t> &_start, std::size_t _count, Key _key, Place _place)
+    {
+        for (std::size_t k = 1; k < _start.size(); ++k) {
+            _start[k] += _start[k - 1];
+        }
+        for (std::size_t i = 0; i < _count; ++i) {
+            _place(i, _start[_key(i)]++);
+        }
+        for (std::size_t k = _start.size() - 1; k > 0; --k) {
+            _start[k] = _start[k - 1];
+        }
+        _start[0] = 0;
+    }
+}
+
+void ShareGraph::build(AgentStore const &_agents, double _radius)
+{
+    members.clear();
+    member_positions.clear();
+    edges.clear();
+
+    if (_radius <= 0.0) {
+        return;
+    }
+
+    int min_x = std::numeric_limits<int>::max(), min_y = min_x;
+    int max_x = std::numeric_limits<int>::min(), max_y = max_x;
+
+    for (std::size_t i = 0; i < _agents.size(); ++i) {
+        Agent const a = _agents[i];
+        if (a.is_alive() && a.share_timer() == 0 && !a.starving()) {
+            Vec2 p = distance_position(a.get_position());
+            members.push_back(i);
+            member_positions.push_back(a.get_position());
+            min_x = std::min(min_x, p.x);
+            min_y = std::min(min_y, p.y);
+            max_x = std::max(max_x, p.x);
+            max_y = std::max(max_y, p.y);
+        }
+    }
+
+    if (members.size() < 2) {
+        return;
+    }
+
+    // euklid_dist obcina odleglosc do liczby calkowitej, wiec sasiedzi moga byc o niecala jednostke dalej niz promien;
+    // komorki nie sa mniejsze niz odstep wierszy mapy, zeby ich ilosc nie przekroczyla ilosci pol
+    const int cell = std::max(static_cast<int>(_radius) + 1, distance_position(Vec2(1, 0)).y);
+    const int cols = (max_x - min_x) / cell + 1;
+    const int rows = (max_y - min_y) / cell + 1;
+
+    member_cells.resize(members.size());
+    cell_start.assign(cols * rows + 1, 0);
+    for (std::size_t k = 0; k < members.size(); ++k) {
+        Vec2 p = distance_position(member_positions[k]);
+        member_cells[k] = ((p.y - min_y) / cell) * cols + (p.x - min_x) / cell;
+        ++cell_start[member_cells[k] + 1];
+    }
+
+    cell_members.resize(members.size());
+    counting_sort(cell_start, members.size(),
+                  [&](std::size_t _k) { return member_cells[_k]; },
+                  [&](std::size_t _k, std::size_t _at) { cell_members[_at] = _k; });
+
+    for (std::size_t k = 0; k < members.size(); ++k) {
+        int cx = static_cast<int>(member_cells[k] % cols);
+        int cy = static_cast<int>(member_cells[k] / cols);
+        Agent const giver = _agents[members[k]];
+
+        for (int y = std::max(cy - 1, 0); y <= std::min(cy + 1, rows - 1); ++y) {
+            for (int x = std::max(cx - 1, 0); x <= std::min(cx + 1, cols - 1); ++x) {
+                std::size_t c = y * cols + x;
+                for (std::size_t m = cell_start[c]; m < cell_start[c + 1]; ++m) {
+                    std::size_t other = cell_members[m];
+                    if (other != k && euklid_dist(member_positions[k], member_positions[other]) < _radius) {
+                        edges.push_back(Edge{ giver.get_id(), _agents[members[other]].get_id(), members[k], members[other] });
+                    }
+                }
+            }
+        }
+    }
+
+    std::sort(edges.begin(), edges.end(), by_ids);
+}
+
+std::vector<ShareGraph::Edge> const & ShareGraph::match()
+{
+    pairs.clear();
+    if (edges.empty()) {
+        return pairs;
+    }
+
+    // indeksy kandydatow sa rosnace, wiec ostatni wyznacza rozmiar tablicy
+    locked.assign(members.back() + 1, 0);
+
+    // krawedzie sa uporzadkowane wg id, wiec wybrane pary rowniez
+    for (auto &&e : edges) {
+        if (!locked[e.giver] && !locked[e.receiver]) {
+            locked[e.giver] = locked[e.receiver] = 1;
+            pairs.push_back(e);
+        }
+    }
+    return pairs;
+}
\ No newline at end of file
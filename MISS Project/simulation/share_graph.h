@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+
+#include "utils.h"
+
+class AgentStore;
+
+/**
+ * Klasa wyznaczajaca pary agentow wymieniajacych wiedze w danym kroku.
+ * Kandydaci (zywi, niewymieniajacy wiedzy, nieglodni) rozkladani sa do siatki przestrzennej
+ * o boku nie mniejszym niz promien wymiany, wiec sprawdzane sa tylko pary z sasiednich komorek.
+ * Krawedzie (dajacy -> otrzymujacy) porzadkowane sa wg id agentow, a pary wybierane zachlannie
+ * jednym przejsciem w tej kolejnosci - wynik nie zalezy od kolejnosci agentow w magazynie.
+ */
+class ShareGraph
+{
+public:
+    /**
+     * Krawedz grafu - mozliwa wymiana wiedzy
+     */
+    struct Edge
+    {
+        unsigned int    giver_id;
+        unsigned int    receiver_id;
+        std::size_t     giver;      // indeksy agentow w magazynie
+        std::size_t     receiver;
+    };
+
+    /**
+     * Metoda buduje graf sasiedztwa agentow mogacych wymienic wiedze
+     * @param agents magazyn agentow
+     * @param radius promien wymiany wiedzy
+     */
+    void build(AgentStore const &, double);
+
+    /**
+     * Metoda usuwa krawedzie niespelniajace warunku (wywolywany w kolejnosci id agentow)
+     * @param accept warunek
+     */
+    template <typename F>
+    void filter(F _accept)
+    {
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < edges.size(); ++i) {
+            if (_accept(edges[i])) {
+                edges[kept++] = edges[i];
+            }
+        }
+        edges.resize(kept);
+    }
+
+    /**
+     * Metoda wybiera rozlaczne pary agentow (kazdy agent wymienia wiedze co najwyzej raz)
+     * @return wybrane pary w kolejnosci id agentow
+     */
+    std::vector<Edge> const & match();
+
+private:
+    std::vector<std::size_t>    members;        // indeksy kandydatow
+    std::vector<Vec2>           member_positions;
+    std::vector<std::size_t>    member_cells;
+    std::vector<std::size_t>    cell_start;     // poczatki komorek w cell_members
+    std::vector<std::size_t>    cell_members;
+
+    std::vector<Edge>           edges;
+    std::vector<Edge>           pairs;
+
+    std::vector<unsigned char>  locked;         // indeksowane numerem agenta w magazynie
+};
\ No newline at end of file
@@ -3,19 +3,19 @@
 #include <iostream>
 
 Simulation::Simulation(Map &_map, SimulationOptions _sim_opts)
-    : simulation_opts(_sim_opts)
-    , map(_map)
+    : map(_map)
+    , simulation_opts(_sim_opts)
+    , agents(simulation_opts, _map.dimensions())
     , environment(_map, simulation_opts)
     , agent_unique_id(0)
-    , viewed_agent(-1)
     , is_done(false)
 {
     if (_sim_opts.common_knowledge) {
-        common_knowledge = std::make_shared<Knowledge>();
+        common_knowledge = std::make_shared<Knowledge>(map.dimensions());
     }
 
     for (int i = 0; i < simulation_opts.start_agent_count; ++i) {
-        agents.emplace_back(map.start(), agent_unique_id++, simulation_opts, common_knowledge);
+        agents.spawn(map.start(), agent_unique_id++, common_knowledge);
     }
 
 }
@@ -31,25 +31,22 @@ void Simulation::step()
     }
     ++simulation_opts.step_counter;
     if (agents.size() > 0) {
+        // sciezki wyznaczane w tle od poprzedniego kroku - przed narodzinami (dziedziczenie czyta wiedze)
+        environment.collect_paths(agents);
+
         if (simulation_opts.step_counter % simulation_opts.agent_spawn_time == 0) {
-            agents.emplace_back(map.start(), agent_unique_id++, simulation_opts, common_knowledge);
+            auto knowledge = common_knowledge;
+            if (!knowledge && simulation_opts.inherit_knowledge) {
+                // kafelki wiedzy rodzica sa wspoldzielone, wiec narodziny nie kopiuja wiedzy
+                knowledge = agents[random_int(0, static_cast<int>(agents.size()) - 1)].get_knowledge().inherit();
+            }
+            agents.spawn(map.start(), agent_unique_id++, knowledge);
         }
 
         environment.step(agents);
 
-        if (viewed_agent != -1) {
-            if (!agents[viewed_agent].is_alive()) {
-                disable_view();
-            } else {
-                int deads = 0;
-                for (int i = 0; i < viewed_agent; ++i) {
-                    if (!agents[i].is_alive()) ++deads;
-                }
-                viewed_agent -= deads;
-            }
-        }
-
-        agents.erase(std::remove_if(agents.begin(), agents.end(), [](auto &&a) { return !a.is_alive(); }), agents.end());
+        // uchwyt martwego podgladanego agenta traci waznosc, co wylacza podglad
+        agents.remove_dead();
     } else {
         is_done = true;
         std::cout << "Population died." << std::endl;
@@ -66,14 +63,9 @@ Environment const & Simulation::get_env() const
     return environment;
 }
 
-void Simulation::draw(sf::RenderTarget &_target, sf::RenderStates _states) const
+CellStats & Simulation::get_stats()
 {
-    map.set_agent_view(viewed_agent != -1 ? &agents.at(viewed_agent) : nullptr);
-
-    _target.draw(map, _states);
-    for (auto &&a : agents) {
-        _target.draw(a, _states);
-    }
+    return environment.get_stats();
 }
 
 bool Simulation::is_finished() const
@@ -86,7 +78,7 @@ unsigned int Simulation::agents_count() const
     return agents.size();
 }
 
-std::vector<Agent> const & Simulation::get_agents() const
+AgentStore const & Simulation::get_agents() const
 {
     return agents;
 }
@@ -97,20 +89,32 @@ void Simulation::show_next_agent()
         return;
     }
 
-    if (viewed_agent != -1) {
-        agents[viewed_agent].set_viewed(false);
+    std::size_t next = 0;
+    if (agents.valid(viewed_agent)) {
+        std::size_t current = agents.slot(viewed_agent);
+        agents[current].set_viewed(false);
+        next = (current + 1) % agents.size();
     }
-    viewed_agent += 1;
-    viewed_agent %= agents.size();
 
-    agents[viewed_agent].set_viewed(true);
+    agents[next].set_viewed(true);
+    viewed_agent = agents.handle(next);
 }
 
 
 void Simulation::disable_view()
 {
-    if (viewed_agent != -1) {
-        agents[viewed_agent].set_viewed(false);
-        viewed_agent = -1;
+    if (agents.valid(viewed_agent)) {
+        agents[agents.slot(viewed_agent)].set_viewed(false);
     }
+    viewed_agent = AgentHandle();
+}
+
+bool Simulation::has_viewed_agent() const
+{
+    return agents.valid(viewed_agent);
+}
+
+Agent const Simulation::get_viewed_agent() const
+{
+    return agents[agents.slot(viewed_agent)];
 }
\ No newline at end of file
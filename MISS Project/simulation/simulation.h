@@ -2,16 +2,15 @@
 
 #include "environment.h"
 #include "agent.h"
+#include "agent_store.h"
 #include "simulation_options.h"
 
-#include <SFML\Graphics.hpp>
-
 #include <vector>
 
 /**
  * Klasa odpowiedzialna za symulacje
  */
-class Simulation : public sf::Drawable
+class Simulation
 {
 public:
     /**
@@ -53,10 +52,10 @@ public:
     unsigned int agents_count() const;
 
     /**
-     * Metoda zwraca wektor zawierajacy agentow w danym kroku symulacji
-     * @return wektor agentow
+     * Metoda zwraca magazyn agentow w danym kroku symulacji
+     * @return magazyn agentow
      */
-    std::vector<Agent> const & get_agents() const;
+    AgentStore const & get_agents() const;
 
     /**
      * Metoda zwraca srodowisko 
@@ -64,6 +63,12 @@ public:
      */
     Environment const & get_env() const;
 
+    /**
+     * Metoda zwraca statystyki pol mapy
+     * @return statystyki pol
+     */
+    CellStats & get_stats();
+
     // -----
 
     /**
@@ -77,19 +82,26 @@ public:
     void disable_view();
 
     /**
-     * Metoda z biblioteki SFML sluzaca do rysowania na oknie
+     * Metoda zwraca informacje czy jakis agent jest podgladany
+     * @return informacja czy podglad jest wlaczony
      */
-    virtual void draw(sf::RenderTarget &_target, sf::RenderStates _states) const override;
+    bool has_viewed_agent() const;
+
+    /**
+     * Metoda zwraca aktualnie podgladanego agenta (tylko gdy has_viewed_agent() zwraca true)
+     * @return uchwyt agenta
+     */
+    Agent const get_viewed_agent() const;
 
 private:
     Map                 &map;
-    std::vector<Agent>  agents;
-    Environment         environment;
     SimulationOptions   simulation_opts;
+    AgentStore          agents;
+    Environment         environment;
 
     std::shared_ptr<Knowledge> common_knowledge;
 
     unsigned int    agent_unique_id;
-    int             viewed_agent;
+    AgentHandle     viewed_agent;
     bool            is_done;
 };
\ No newline at end of file
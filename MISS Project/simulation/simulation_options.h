@@ -63,6 +63,9 @@ struct SimulationOptions
     // czas miedzy krokami (dotyczy wyswietlania)
     double step_time = 0.016;
 
+    // ilosc krokow na klatke w trybie przyspieszonym (0 - tyle ile zmiesci sie w czasie klatki)
+    unsigned int turbo_steps = 0;
+
     // czas w krokach jaki agent jest w stanie przetwac bez wody lub jedzenia (po ktorym umiera)
     unsigned int foodless_survival = 100;
 
@@ -72,9 +75,30 @@ struct SimulationOptions
     // okresla ile razy mozna pobrac jedzenie lub wode z danego pola
     unsigned int default_field_value = 10;
 
+    // ilosc watkow wyznaczajacych sciezki (0 - sciezki wyznaczane synchronicznie w ruchu agenta)
+    unsigned int planner_threads = 0;
+
+    // ilosc dodatkowych watkow wymieniajacych wiedze miedzy parami agentow (0 - wymiana w watku symulacji)
+    unsigned int share_threads = 0;
+
     // wspolna wiedza
     bool common_knowledge = false;
 
+    // nowy agent dziedziczy wiedze losowego zyjacego agenta (bez wspolnej wiedzy)
+    bool inherit_knowledge = false;
+
+    // limit wiedzy agenta w kafelkach 32x32 pol (0 - bez ograniczenia, bez wspolnej wiedzy)
+    unsigned int knowledge_budget = 0;
+
+    // wybor zapominanego kafelka (0 - najdawniej zmieniany, 1 - najpierw bez dobrych i zlych pol)
+    unsigned int knowledge_eviction = 0;
+
+    // agent porzuca sciezke przez pole zmienione od jej wyznaczenia na zablokowane lub niebezpieczne
+    bool path_validation = false;
+
+    // limit alokacji pamieci na krok w drugiej polowie testu (tryb test, kompilacja z MISS_COUNT_ALLOCATIONS, 0 - bez limitu)
+    double max_allocs_per_step = 0.0;
+
     // licznik krokow
     int step_counter = 0;
 
@@ -0,0 +1,337 @@
+#include "simulation_runner.h"
+
+#include <chrono>
+#include <algorithm>
+
+namespace
+{
+    using clock_type = std::chrono::steady_clock;
+
+    // migawki publikowane sa nie czesciej niz co tyle czasu
+    const auto publish_interval = std::chrono::milliseconds(8);
+
+    // maksymalny czas oczekiwania watku symulacji na polecenia
+    const auto idle_wait = std::chrono::milliseconds(10);
+}
+
+void SimulationSnapshot::merge(SimulationSnapshot &&_newer)
+{
+    step = _newer.step;
+    steps_per_second = _newer.steps_per_second;
+    agents_count = _newer.agents_count;
+    total_food = _newer.total_food;
+    finished = _newer.finished;
+    viewed_agent = _newer.viewed_agent;
+    heat_layer = _newer.heat_layer;
+    heat_max = _newer.heat_max;
+
+    agents.swap(_newer.agents);
+    changed_fields.insert(changed_fields.end(), _newer.changed_fields.begin(), _newer.changed_fields.end());
+
+    if (_newer.knowledge_reset) {
+        knowledge.swap(_newer.knowledge);
+        knowledge_reset = true;
+    } else {
+        knowledge.insert(knowledge.end(), _newer.knowledge.begin(), _newer.knowledge.end());
+    }
+
+    if (_newer.heat_reset) {
+        heat.swap(_newer.heat);
+        heat_reset = true;
+    } else {
+        heat.insert(heat.end(), _newer.heat.begin(), _newer.heat.end());
+    }
+}
+
+void SimulationSnapshot::clear_changes()
+{
+    changed_fields.clear();
+    knowledge.clear();
+    knowledge_reset = false;
+    heat.clear();
+    heat_reset = false;
+}
+
+// -----
+
+SimulationRunner::SimulationRunner(Simulation &_simulation, Map &_map)
+    : simulation(_simulation)
+    , map(_map)
+    , quit(false)
+    , running(false)
+    , turbo(false)
+    , has_commands(false)
+    , heat_layer(-1)
+    , state_changed(false)
+    , fresh(false)
+    , field_changes(std::make_shared<std::vector<FieldChange>>())
+    , knowledge_changes(std::make_shared<std::vector<Vec2>>())
+    , published_view(-1)
+    , published_heat(-1)
+    , steps_per_second(0.0)
+{
+}
+
+SimulationRunner::~SimulationRunner()
+{
+    stop();
+}
+
+void SimulationRunner::start()
+{
+    if (worker.joinable()) {
+        return;
+    }
+
+    quit = false;
+    map.subscribe(field_changes);
+    simulation.get_stats().track_changes(true);
+    worker = std::thread(&SimulationRunner::run, this);
+}
+
+void SimulationRunner::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(commands_mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void SimulationRunner::set_running(bool _running)
+{
+    running = _running;
+    notify_state();
+}
+
+void SimulationRunner::set_turbo(bool _turbo)
+{
+    turbo = _turbo;
+    notify_state();
+}
+
+void SimulationRunner::set_heat_layer(int _layer)
+{
+    heat_layer = _layer;
+    notify_state();
+}
+
+void SimulationRunner::post(Command _command)
+{
+    {
+        std::lock_guard<std::mutex> lock(commands_mutex);
+        commands.push_back(std::move(_command));
+        has_commands = true;
+    }
+    wake.notify_all();
+}
+
+bool SimulationRunner::fetch(SimulationSnapshot &_snapshot)
+{
+    std::lock_guard<std::mutex> lock(snapshot_mutex);
+    if (!fresh) {
+        return false;
+    }
+
+    std::swap(_snapshot, shared);
+    shared.clear_changes();
+    fresh = false;
+    return true;
+}
+
+// -----
+
+void SimulationRunner::run()
+{
+    auto last_step = clock_type::now();
+    auto last_publish = last_step - publish_interval;
+    bool dirty = true;
+    unsigned int frame_steps = 0;
+
+    auto rate_start = last_step;
+    int rate_steps = simulation.get_options().step_counter;
+
+    std::vector<Command> pending;
+
+    while (!quit) {
+        {
+            std::lock_guard<std::mutex> lock(commands_mutex);
+            pending.swap(commands);
+            has_commands = false;
+        }
+        for (auto &&command : pending) {
+            command(simulation, map);
+        }
+        dirty = dirty || !pending.empty() || heat_layer != published_heat;
+        pending.clear();
+
+        // -----
+
+        auto step_time = std::chrono::duration_cast<clock_type::duration>(
+            std::chrono::duration<double>(simulation.get_options().step_time));
+        unsigned int turbo_steps = simulation.get_options().turbo_steps;
+        bool fast = turbo;
+        bool can_step = running && !simulation.is_finished() &&
+                        (!fast || turbo_steps == 0 || frame_steps < turbo_steps);
+        bool stepped = false;
+
+        if (can_step && fast) {
+            // tryb przyspieszony - kroki az do wyczerpania czasu klatki lub limitu krokow
+            auto frame_end = last_publish + publish_interval;
+            do {
+                simulation.step();
+                ++frame_steps;
+            } while (!quit && !has_commands && !simulation.is_finished() &&
+                     (turbo_steps == 0 || frame_steps < turbo_steps) && clock_type::now() < frame_end);
+            last_step = clock_type::now();
+            stepped = true;
+            dirty = true;
+        } else if (can_step && clock_type::now() - last_step >= step_time) {
+            last_step = clock_type::now();
+            simulation.step();
+            ++frame_steps;
+            stepped = true;
+            dirty = true;
+        }
+
+        if (clock_type::now() - rate_start >= std::chrono::milliseconds(500)) {
+            auto elapsed = std::chrono::duration<double>(clock_type::now() - rate_start).count();
+            steps_per_second = (simulation.get_options().step_counter - rate_steps) / elapsed;
+            rate_steps = simulation.get_options().step_counter;
+            rate_start = clock_type::now();
+            dirty = true;
+        }
+
+        if (dirty && clock_type::now() - last_publish >= publish_interval) {
+            publish();
+            last_publish = clock_type::now();
+            frame_steps = 0;
+            dirty = false;
+        }
+
+        // -----
+
+        if (!stepped) {
+            auto timeout = std::chrono::duration_cast<clock_type::duration>(idle_wait);
+            if (can_step && !fast) {
+                timeout = std::min(timeout, step_time - (clock_type::now() - last_step));
+            }
+            if (dirty) {
+                timeout = std::min(timeout, publish_interval - (clock_type::now() - last_publish));
+            }
+            if (timeout > clock_type::duration::zero()) {
+                std::unique_lock<std::mutex> lock(commands_mutex);
+                wake.wait_for(lock, timeout, [&]() { return quit || state_changed || !commands.empty(); });
+                state_changed = false;
+            }
+        }
+    }
+}
+
+void SimulationRunner::notify_state()
+{
+    // flaga ustawiana pod mutexem, zeby zmiana nie trafila miedzy sprawdzenie warunku a zasniecie watku
+    {
+        std::lock_guard<std::mutex> lock(commands_mutex);
+        state_changed = true;
+    }
+    wake.notify_all();
+}
+
+void SimulationRunner::publish()
+{
+    auto &opts = simulation.get_options();
+    back.step = opts.step_counter;
+    back.steps_per_second = steps_per_second;
+    back.agents_count = simulation.agents_count();
+    back.total_food = opts.total_food;
+    back.finished = simulation.is_finished();
+
+    back.agents.clear();
+    for (auto &&a : simulation.get_agents()) {
+        back.agents.push_back(a.sprite());
+    }
+
+    for (auto &&c : *field_changes) {
+        back.changed_fields.emplace_back(c.pos, map.get_field(c.pos));
+    }
+    field_changes->clear();
+
+    // -----
+
+    bool viewing = simulation.has_viewed_agent();
+    int view = viewing ? static_cast<int>(simulation.get_viewed_agent().get_id()) : -1;
+
+    if (view != published_view) {
+        // zmiana podgladu - cala wiedza agenta przesylana jest od nowa
+        knowledge_changes = std::make_shared<std::vector<Vec2>>();
+        back.knowledge_reset = true;
+        back.knowledge.clear();
+
+        if (viewing) {
+            auto viewed = simulation.get_viewed_agent();
+            auto &&knowledge = viewed.get_knowledge();
+            knowledge.observer = knowledge_changes;
+            auto publish = [&](Vec2 const &_p) {
+                back.knowledge.emplace_back(_p, viewed.know_of(_p));
+            };
+            knowledge.for_each(KnowledgeTiles::Known, publish);
+            knowledge.for_each(KnowledgeTiles::Blocked, publish);
+        }
+        published_view = view;
+    } else if (viewing) {
+        auto viewed = simulation.get_viewed_agent();
+        for (auto &&p : *knowledge_changes) {
+            back.knowledge.emplace_back(p, viewed.know_of(p));
+        }
+    }
+    knowledge_changes->clear();
+    back.viewed_agent = view;
+
+    // -----
+
+    auto &stats = simulation.get_stats();
+    int layer = heat_layer;
+
+    heat_changes.clear();
+    stats.take_changes(heat_changes);
+
+    if (layer != published_heat) {
+        // zmiana warstwy - wszystkie niezerowe wartosci przesylane sa od nowa
+        back.heat_reset = true;
+        back.heat.clear();
+
+        if (layer >= 0) {
+            int width = map.dimensions().x;
+            auto &&values = stats.values(static_cast<CellStats::Counter>(layer));
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                if (values[i] > 0) {
+                    back.heat.emplace_back(Vec2(static_cast<int>(i) / width, static_cast<int>(i) % width), values[i]);
+                }
+            }
+        }
+        published_heat = layer;
+    } else if (layer >= 0) {
+        for (auto &&p : heat_changes) {
+            back.heat.emplace_back(p, stats.get(static_cast<CellStats::Counter>(layer), p));
+        }
+    }
+    back.heat_layer = layer;
+    back.heat_max = layer >= 0 ? stats.max_value(static_cast<CellStats::Counter>(layer)) : 0;
+
+    // -----
+
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex);
+        if (fresh) {
+            shared.merge(std::move(back));
+        } else {
+            std::swap(shared, back);
+        }
+        fresh = true;
+    }
+    back.clear_changes();
+}
\ No newline at end of file
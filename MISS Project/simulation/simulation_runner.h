@@ -0,0 +1,178 @@
+#pragma once
+
+#include "simulation.h"
+#include "agent_renderer.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * Struktura z migawka stanu symulacji przekazywana do watku rysujacego.
+ * Zmiany pol mapy i wiedzy sa przyrostowe - jesli watek rysujacy nie odebral
+ * poprzedniej migawki, kolejne zmiany sa do niej dopisywane.
+ */
+struct SimulationSnapshot
+{
+    int             step = 0;
+    double          steps_per_second = 0.0;
+    unsigned int    agents_count = 0;
+    unsigned int    total_food = 0;
+    bool            finished = false;
+
+    // pozycje i stany wszystkich agentow
+    std::vector<AgentSprite> agents;
+
+    // pola mapy zmienione od poprzedniej migawki
+    std::vector<std::pair<Vec2, Field>> changed_fields;
+
+    // id podgladanego agenta (-1 gdy podglad jest wylaczony)
+    int viewed_agent = -1;
+
+    // informacja czy wiedza podgladanego agenta jest przesylana od nowa (zmiana podgladu)
+    bool knowledge_reset = false;
+
+    // wiedza podgladanego agenta o polach (wartosci jak w Agent::know_of)
+    std::vector<std::pair<Vec2, int>> knowledge;
+
+    // wyswietlana warstwa statystyk pol (CellStats::Counter, -1 gdy wylaczona)
+    int heat_layer = -1;
+
+    // informacja czy warstwa statystyk jest przesylana od nowa (zmiana warstwy)
+    bool heat_reset = false;
+
+    // najwieksza wartosc w warstwie statystyk
+    unsigned int heat_max = 0;
+
+    // zmienione wartosci warstwy statystyk
+    std::vector<std::pair<Vec2, unsigned int>> heat;
+
+    /**
+     * Metoda dopisuje do migawki zmiany z nowszej migawki
+     * @param newer nowsza migawka
+     */
+    void merge(SimulationSnapshot &&);
+
+    /**
+     * Metoda czysci przyrostowe czesci migawki
+     */
+    void clear_changes();
+};
+
+/**
+ * Klasa wykonujaca symulacje w osobnym watku.
+ * Watek rysujacy odbiera migawki stanu, a zmiany z interfejsu przekazuje jako polecenia
+ * wykonywane przez watek symulacji miedzy krokami.
+ */
+class SimulationRunner
+{
+public:
+    using Command = std::function<void(Simulation &, Map &)>;
+
+    /**
+     * Konstruktor
+     * @param simulation symulacja
+     * @param map mapa symulacji
+     */
+    SimulationRunner(Simulation &, Map &);
+
+    SimulationRunner(SimulationRunner const &) = delete;
+    SimulationRunner& operator=(SimulationRunner const &) = delete;
+
+    /**
+     * Destruktor zatrzymujacy watek symulacji
+     */
+    ~SimulationRunner();
+
+    /**
+     * Metoda uruchamia watek symulacji
+     */
+    void start();
+
+    /**
+     * Metoda zatrzymuje watek symulacji
+     */
+    void stop();
+
+    /**
+     * Metoda wlacza lub wstrzymuje wykonywanie krokow symulacji
+     * @param running
+     */
+    void set_running(bool);
+
+    /**
+     * Metoda wlacza tryb przyspieszony - kroki wykonywane sa bez przerw (z pominieciem step_time),
+     * a do watku rysujacego trafia tylko najnowszy stan
+     * @param turbo
+     */
+    void set_turbo(bool);
+
+    /**
+     * Metoda wybiera warstwe statystyk pol przesylana do watku rysujacego
+     * @param layer licznik (CellStats::Counter) lub -1 aby wylaczyc warstwe
+     */
+    void set_heat_layer(int);
+
+    /**
+     * Metoda dodaje polecenie do wykonania przez watek symulacji
+     * @param command polecenie
+     */
+    void post(Command);
+
+    /**
+     * Metoda pobiera najnowsza migawke stanu symulacji
+     * @param out snapshot migawka (zamieniana z wewnetrznym buforem)
+     * @return informacja czy pojawila sie nowa migawka
+     */
+    bool fetch(SimulationSnapshot &);
+
+protected:
+    /**
+     * Glowna petla watku symulacji
+     */
+    void run();
+
+    /**
+     * Metoda przygotowuje migawke stanu i przekazuje ja do watku rysujacego
+     */
+    void publish();
+
+    /**
+     * Metoda budzi watek symulacji po zmianie stanu (wstrzymanie, tryb przyspieszony, warstwa statystyk)
+     */
+    void notify_state();
+
+private:
+    Simulation  &simulation;
+    Map         &map;
+
+    std::thread             worker;
+    std::atomic<bool>       quit;
+    std::atomic<bool>       running;
+    std::atomic<bool>       turbo;
+    std::atomic<bool>       has_commands;
+    std::atomic<int>        heat_layer;
+
+    std::mutex              commands_mutex;
+    std::condition_variable wake;
+    std::vector<Command>    commands;
+    bool                    state_changed;  // zmiana stanu od ostatniego oczekiwania (chroniona commands_mutex)
+
+    std::mutex              snapshot_mutex;
+    SimulationSnapshot      shared;
+    SimulationSnapshot      back;
+    bool                    fresh;
+
+    std::shared_ptr<std::vector<FieldChange>> field_changes;
+    std::shared_ptr<std::vector<Vec2>> knowledge_changes;
+    int                                published_view;
+
+    std::vector<Vec2>                  heat_changes;
+    int                                published_heat;
+
+    double                             steps_per_second;
+};
\ No newline at end of file
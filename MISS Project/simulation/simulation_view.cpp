@@ -0,0 +1,177 @@
+#include "simulation_view.h"
+
+#include <algorithm>
+#include <cmath>
+
+SimulationView::SimulationView()
+    : width(0)
+    , height(0)
+    , viewing(false)
+    , heat_layer(-1)
+    , heat_bits(0)
+{
+}
+
+void SimulationView::reset(Map const &_map)
+{
+    width = _map.dimensions().x;
+    height = _map.dimensions().y;
+    viewing = false;
+
+    fields.resize(width * height);
+    for (int i = 0; i < height; ++i) {
+        for (int j = 0; j < width; ++j) {
+            fields[i * width + j] = _map.get_field(Vec2(i, j));
+        }
+    }
+    knowledge.assign(width * height, 0);
+
+    map_renderer.reset(_map.dimensions());
+    for (int i = 0; i < height; ++i) {
+        for (int j = 0; j < width; ++j) {
+            map_renderer.set_color(Vec2(i, j), field_color(Vec2(i, j)));
+        }
+    }
+
+    knowledge_overlay.reset(_map.dimensions());
+    knowledge_overlay.set_visible(false);
+
+    heat.assign(width * height, 0);
+    heat_layer = -1;
+    heat_bits = 0;
+    heat_overlay.reset(_map.dimensions());
+    heat_overlay.set_visible(false);
+}
+
+void SimulationView::apply(SimulationSnapshot const &_snapshot)
+{
+    for (auto &&f : _snapshot.changed_fields) {
+        fields[f.first.y * width + f.first.x] = f.second;
+        map_renderer.set_color(f.first, field_color(f.first));
+        if (viewing) {
+            knowledge_overlay.set_color(f.first, knowledge_color(f.first));
+        }
+    }
+
+    if (_snapshot.knowledge_reset) {
+        viewing = _snapshot.viewed_agent != -1;
+        knowledge_overlay.set_visible(viewing);
+        std::fill(knowledge.begin(), knowledge.end(), 0);
+        knowledge_overlay.fill(knowledge_color(Vec2(-1, -1)));
+    }
+
+    if (viewing) {
+        for (auto &&k : _snapshot.knowledge) {
+            if (k.first.x >= 0 && k.first.x < width && k.first.y >= 0 && k.first.y < height) {
+                knowledge[k.first.y * width + k.first.x] = static_cast<char>(k.second);
+                knowledge_overlay.set_color(k.first, knowledge_color(k.first));
+            }
+        }
+    }
+
+    // -----
+
+    if (_snapshot.heat_reset) {
+        heat_layer = _snapshot.heat_layer;
+        heat_overlay.set_visible(heat_layer >= 0);
+        std::fill(heat.begin(), heat.end(), 0);
+        heat_overlay.fill(sf::Color::Transparent);
+    }
+
+    if (heat_layer >= 0) {
+        for (auto &&h : _snapshot.heat) {
+            if (h.first.x >= 0 && h.first.x < width && h.first.y >= 0 && h.first.y < height) {
+                heat[h.first.y * width + h.first.x] = h.second;
+            }
+        }
+
+        // skala zmienia sie tylko gdy maksimum przekroczy kolejna potege dwojki
+        int bits = 0;
+        for (unsigned int m = _snapshot.heat_max; m > 0; m >>= 1) {
+            ++bits;
+        }
+
+        if (bits != heat_bits || _snapshot.heat_reset) {
+            heat_bits = bits;
+            recolor_heat();
+        } else {
+            for (auto &&h : _snapshot.heat) {
+                heat_overlay.set_color(h.first, heat_color(h.first));
+            }
+        }
+    }
+
+    agent_renderer.update(_snapshot.agents);
+}
+
+void SimulationView::draw(sf::RenderTarget &_target, sf::RenderStates _states) const
+{
+    _target.draw(map_renderer, _states);
+    _target.draw(heat_overlay, _states);
+    _target.draw(knowledge_overlay, _states);
+    _target.draw(agent_renderer, _states);
+}
+
+// -----
+
+sf::Color SimulationView::field_color(Vec2 const &_pos) const
+{
+    auto place = fields[_pos.y * width + _pos.x];
+
+    if (place == Field::Blocked) {
+        return sf::Color(190, 190, 190);
+    } else if (place == Field::Food) {
+        return sf::Color(106, 196, 49);
+    } else if (place == Field::Danger) {
+        return sf::Color(224, 38, 38);
+    } else if (place == Field::Water) {
+        return sf::Color(49, 123, 196);
+    } else if (place == Field::Population) {
+        return sf::Color(176, 86, 232);
+    }
+    return sf::Color::White;
+}
+
+sf::Color SimulationView::knowledge_color(Vec2 const &_pos) const
+{
+    // pole spoza mapy - kolor nieznanego pola (do wypelnienia calej warstwy)
+    if (_pos.x < 0 || _pos.x >= width || _pos.y < 0 || _pos.y >= height) {
+        return sf::Color(255, 255, 255, 155);
+    }
+
+    int k = knowledge[_pos.y * width + _pos.x];
+    if (k == 4) {
+        return sf::Color(220, 220, 220, 255);
+    } else if (k == 3) {
+        return sf::Color(173, 255, 47, 255);
+    } else if (k == 2) {
+        return sf::Color(255, 140, 0, 255);
+    } else if (k == 0) {
+        // nieznane pole - polprzezroczysty bialy (pole mapy z alfa 100 na bialym tle)
+        return sf::Color(255, 255, 255, 155);
+    } else if (fields[_pos.y * width + _pos.x] == Field::Empty) {
+        return sf::Color(176, 226, 255, 255);
+    }
+    return sf::Color::Transparent;
+}
+
+sf::Color SimulationView::heat_color(Vec2 const &_pos) const
+{
+    unsigned int v = heat[_pos.y * width + _pos.x];
+    if (v == 0 || heat_bits == 0) {
+        return sf::Color::Transparent;
+    }
+
+    // od zoltego (rzadko) do czerwonego (najczesciej)
+    float t = std::min(1.0f, static_cast<float>(std::log2(v + 1.0) / heat_bits));
+    return sf::Color(255, static_cast<sf::Uint8>(230 * (1.0f - t)), 0, static_cast<sf::Uint8>(60 + 160 * t));
+}
+
+void SimulationView::recolor_heat()
+{
+    for (int i = 0; i < height; ++i) {
+        for (int j = 0; j < width; ++j) {
+            heat_overlay.set_color(Vec2(i, j), heat_color(Vec2(i, j)));
+        }
+    }
+}
\ No newline at end of file
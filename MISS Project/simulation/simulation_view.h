@@ -0,0 +1,86 @@
+#pragma once
+
+#include "map.h"
+#include "map_renderer.h"
+#include "overlay_renderer.h"
+#include "agent_renderer.h"
+#include "simulation_runner.h"
+
+#include <SFML\Graphics.hpp>
+
+#include <vector>
+
+/**
+ * Klasa odpowiedzialna za rysowanie symulacji w watku rysujacym.
+ * Przechowuje wlasna kopie pol mapy i wiedzy podgladanego agenta, aktualizowana migawkami
+ * z watku symulacji, wiec nigdy nie odwoluje sie do obiektow symulacji.
+ * Statystyki pol (mapa ciepla) i wiedza podgladanego agenta rysowane sa osobnymi warstwami nad mapa.
+ */
+class SimulationView : public sf::Drawable
+{
+public:
+    /**
+     * Konstruktor
+     */
+    SimulationView();
+
+    /**
+     * Metoda kopiuje stan poczatkowy mapy (przed uruchomieniem watku symulacji)
+     * @param map mapa
+     */
+    void reset(Map const &);
+
+    /**
+     * Metoda nanosi zmiany z migawki stanu symulacji
+     * @param snapshot migawka
+     */
+    void apply(SimulationSnapshot const &);
+
+    /**
+     * Metoda z biblioteki SFML sluzaca do rysowania na oknie
+     */
+    virtual void draw(sf::RenderTarget &, sf::RenderStates) const override;
+
+protected:
+    /**
+     * Metoda wyznacza kolor pola mapy
+     * @param pos pozycja pola
+     * @return kolor pola
+     */
+    sf::Color field_color(Vec2 const &) const;
+
+    /**
+     * Metoda wyznacza kolor warstwy wiedzy podgladanego agenta nad danym polem
+     * @param pos pozycja pola
+     * @return kolor warstwy (przezroczysty gdy pole rysowane jest bez zmian)
+     */
+    sf::Color knowledge_color(Vec2 const &) const;
+
+    /**
+     * Metoda wyznacza kolor mapy ciepla nad danym polem (skala logarytmiczna)
+     * @param pos pozycja pola
+     * @return kolor warstwy
+     */
+    sf::Color heat_color(Vec2 const &) const;
+
+    /**
+     * Metoda przelicza kolory calej mapy ciepla
+     */
+    void recolor_heat();
+
+private:
+    std::vector<Field>  fields;
+    std::vector<char>   knowledge;
+    int                 width;
+    int                 height;
+    bool                viewing;
+
+    std::vector<unsigned int>   heat;
+    int                         heat_layer;
+    int                         heat_bits;
+
+    MapRenderer         map_renderer;
+    OverlayRenderer     heat_overlay;
+    OverlayRenderer     knowledge_overlay;
+    AgentRenderer       agent_renderer;
+};
\ No newline at end of file
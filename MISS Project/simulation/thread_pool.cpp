@@ -0,0 +1,85 @@
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(unsigned int _threads)
+    : quit(false)
+    , task(nullptr)
+    , count(0)
+    , next(0)
+    , generation(0)
+    , busy(0)
+{
+    for (unsigned int i = 0; i < _threads; ++i) {
+        workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (auto &&w : workers) {
+        w.join();
+    }
+}
+
+void ThreadPool::parallel_for(std::size_t _count, std::function<void(std::size_t)> const &_task)
+{
+    // przy jednym zadaniu lub braku watkow nie oplaca sie budzic puli
+    if (workers.empty() || _count < 2) {
+        for (std::size_t i = 0; i < _count; ++i) {
+            _task(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &_task;
+        count = _count;
+        next = 0;
+        busy = static_cast<unsigned int>(workers.size());
+        ++generation;
+    }
+    wake.notify_all();
+
+    run_tasks();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&]() { return busy == 0; });
+    task = nullptr;
+}
+
+// -----
+
+void ThreadPool::work()
+{
+    unsigned int seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]() { return quit || generation != seen; });
+            if (quit) {
+                return;
+            }
+            seen = generation;
+        }
+
+        run_tasks();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --busy;
+        }
+        finished.notify_one();
+    }
+}
+
+void ThreadPool::run_tasks()
+{
+    for (std::size_t i = next++; i < count; i = next++) {
+        (*task)(i);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+/**
+ * Prosta pula watkow wykonujaca petle rownolegle.
+ * Watek wywolujacy rowniez wykonuje czesc pracy i czeka na zakonczenie calej petli.
+ */
+class ThreadPool
+{
+public:
+    /**
+     * Konstruktor
+     * @param threads ilosc dodatkowych watkow roboczych
+     */
+    explicit ThreadPool(unsigned int);
+
+    ThreadPool(ThreadPool const &) = delete;
+    ThreadPool& operator=(ThreadPool const &) = delete;
+
+    /**
+     * Destruktor zatrzymujacy watki robocze
+     */
+    ~ThreadPool();
+
+    /**
+     * Metoda wykonuje zadanie dla kazdego indeksu z zakresu [0, count) i czeka na zakonczenie
+     * @param count ilosc indeksow
+     * @param task zadanie wywolywane z indeksem (moze byc wywolywane jednoczesnie z wielu watkow)
+     */
+    void parallel_for(std::size_t, std::function<void(std::size_t)> const &);
+
+protected:
+    /**
+     * Glowna petla watku roboczego
+     */
+    void work();
+
+    /**
+     * Metoda wykonuje kolejne indeksy biezacej petli
+     */
+    void run_tasks();
+
+private:
+    std::vector<std::thread>    workers;
+    std::mutex                  mutex;
+    std::condition_variable     wake;
+    std::condition_variable     finished;
+    bool                        quit;
+
+    // biezaca petla
+    std::function<void(std::size_t)> const *task;
+    std::size_t                 count;
+    std::atomic<std::size_t>    next;
+    unsigned int                generation;
+    unsigned int                busy;
+};
\ No newline at end of file
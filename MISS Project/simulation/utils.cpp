@@ -1,7 +1,7 @@
 #include "utils.h"
 
 #include <random>
-#include <deque>
+#include "scratch.h"
 #include <algorithm>
 
 Vec2::Vec2(int _y, int _x)
@@ -50,11 +50,16 @@ Vec2 position_hex(double _radius, Vec2 const &_p)
     return position_hex(_radius, _p.y, _p.x);
 }
 
+Vec2 distance_position(Vec2 const &_v)
+{
+    static const double radius = std::ceil(std::sqrt(3) * 25);
+    return hex_position(radius, _v);
+}
+
 int euklid_dist(Vec2 const &_a, Vec2 const &_b)
 {
-    const double radius = std::ceil(std::sqrt(3) * 25);
-    auto p1 = hex_position(radius, _a);
-    auto p2 = hex_position(radius, _b);
+    auto p1 = distance_position(_a);
+    auto p2 = distance_position(_b);
     double d1 = p1.x - p2.x;
     double d2 = p1.y - p2.y;
     return static_cast<int>(std::sqrt(d1 * d1 + d2 * d2));
@@ -77,31 +82,36 @@ std::vector<Vec2> hex_places(Vec2 const &_p)
     return hex_places(_p.y, _p.x);
 }
 
-std::vector<std::pair<Vec2, double>> distribute_point(Vec2 const &_point, int _radius, double _val)
+void distribute_point(Vec2 const &_point, int _radius, double _val, std::vector<std::pair<Vec2, double>> &result)
 {
-    std::vector<std::pair<Vec2, double>> result;
+    result.clear();
 
-    std::deque<std::pair<Vec2, int>> q;
+    // kolejka FIFO w buforze tymczasowym (elementy nie sa usuwane, przesuwa sie tylko poczatek)
+    ScratchVector<std::pair<Vec2, int>> queue;
+    auto &q = *queue;
     q.push_back({ _point, 0 });
-    while (!q.empty()) {
-        auto top = q.front();
-        q.pop_front();
+    for (std::size_t head = 0; head < q.size(); ++head) {
+        auto top = q[head];
         if (top.second >= _radius) continue;
         result.push_back({ top.first, _val / 10.0 /*static_cast<double>(_radius)*/ });
-        for (auto &&p : hex_places(top.first)) {
+        int y = top.first.y, x = top.first.x;
+        const Vec2 near[6] = {
+            { y, x - 1 }, { y, x + 1 },
+            { y - 1, x - 1 + y % 2 }, { y - 1, x + y % 2 },
+            { y + 1, x - 1 + y % 2 }, { y + 1, x + y % 2 }
+        };
+        for (auto &&p : near) {
             q.push_back({ p, top.second + 1 });
         }
     }
 
     std::sort(result.begin(), result.end());
     result.erase(std::unique(result.begin(), result.end()), result.end());
-
-    return result;
 }
 
-std::vector<Vec2> on_line(Vec2 const &_p1, Vec2 const &_p2)
+void on_line(Vec2 const &_p1, Vec2 const &_p2, std::vector<Vec2> &result)
 {
-    std::vector<Vec2> result;
+    result.clear();
 
     double dx = _p1.x - _p2.x;
     double dy = _p1.y - _p2.y;
@@ -118,8 +128,6 @@ std::vector<Vec2> on_line(Vec2 const &_p1, Vec2 const &_p2)
 
     std::sort(result.begin(), result.end());
     result.erase(std::unique(result.begin(), result.end()), result.end());
-
-    return result;
 }
 
 bool are_same(double _a, double _b)
@@ -165,6 +173,30 @@ double random_double()
     return distr(random.generator);
 }
 
+RandomStream::RandomStream(unsigned long long _seed)
+    : state(_seed)
+{
+}
+
+unsigned long long RandomStream::next()
+{
+    unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+int RandomStream::next_int(int _min, int _max)
+{
+    unsigned long long range = static_cast<unsigned long long>(static_cast<long long>(_max) - _min) + 1;
+    return static_cast<int>(_min + static_cast<long long>(next() % range));
+}
+
+double RandomStream::next_double()
+{
+    return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
 // -----
 
 std::vector<std::string> split(std::string _str, char _on)
@@ -187,4 +219,48 @@ std::string trim(std::string _str)
     for (b = 0; b < _str.size() && (_str[b] == ' ' || _str[b] == '\t' || _str[b] == '\n'); ++b);
     for (e = _str.size() - 1; e >= 0 && (_str[e] == ' ' || _str[e] == '\t' || _str[e] == '\n'); --e);
     return _str.substr(b, e - b + 1);
-}
\ No newline at end of file
+}
+
+// -----
+
+#ifdef MISS_COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<unsigned long long> allocations(0);
+}
+
+unsigned long long allocation_count()
+{
+    return allocations.load();
+}
+
+void* operator new(std::size_t _size)
+{
+    ++allocations;
+    if (void *ptr = std::malloc(_size ? _size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t _size)
+{
+    return operator new(_size);
+}
+
+void operator delete(void *_ptr) noexcept
+{
+    std::free(_ptr);
+}
+
+void operator delete[](void *_ptr) noexcept
+{
+    std::free(_ptr);
+}
+
+#endif
\ No newline at end of file
@@ -52,20 +52,34 @@ Vec2 position_hex(double _radius, int _y, int _x);
 
 Vec2 position_hex(double _radius, Vec2 const &);
 
+/**
+ * Pozycja pola w jednostkach odleglosci zwracanej przez euklid_dist
+ */
+Vec2 distance_position(Vec2 const &);
+
 int euklid_dist(Vec2 const &, Vec2 const &);
 
 std::vector<Vec2> hex_places(int _y, int _x);
 
 std::vector<Vec2> hex_places(Vec2 const &);
 
-std::vector<std::pair<Vec2, double>> distribute_point(Vec2 const &, int, double);
+void distribute_point(Vec2 const &, int, double, std::vector<std::pair<Vec2, double>> &);
 
-std::vector<Vec2> on_line(Vec2 const &, Vec2 const &);
+void on_line(Vec2 const &, Vec2 const &, std::vector<Vec2> &);
 
 bool are_same(double, double);
 
 double clamp(double, double, double);
 
+#ifdef MISS_COUNT_ALLOCATIONS
+/**
+ * Ilosc alokacji pamieci od startu programu (zastapione operatory new/delete, tylko do pomiarow).
+ * Po rozgrzaniu alokuja jedynie rosnace struktury: wiedza nowych agentow, pierwsze poznanie pola
+ * (takze poza mapa), pierwsza wymiana wiedzy danej pary agentow oraz bufory nowych miejsc w AgentStore.
+ */
+unsigned long long allocation_count();
+#endif
+
 // --- randomness
 
 Vec2 random_element(std::unordered_set<Vec2> const &);
@@ -74,6 +88,25 @@ int random_int(int, int);
 
 double random_double();
 
+/**
+ * Deterministyczny strumien liczb losowych (splitmix64) - ten sam ciag dla danego ziarna
+ * niezaleznie od platformy i biblioteki standardowej
+ */
+class RandomStream
+{
+public:
+    explicit RandomStream(unsigned long long _seed = 0);
+
+    unsigned long long next();
+
+    int next_int(int, int); // inclusive
+
+    double next_double();
+
+private:
+    unsigned long long state;
+};
+
 // -----
 
 std::vector<std::string> split(std::string _str, char _on);